@@ -1,12 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <raygui.h>
 #include <raylib-cpp.hpp>
+#include <rlgl.h>
 
+#include "background_solver.hpp"
 #include "common.hpp"
-#include "full_board_solver.hpp"
 #include "res/roboto-regular.h"
 
 enum class GameState { manual, solving };
@@ -40,17 +51,30 @@ public:
     void update_and_draw()
     {
         update_game();
+        // Cells of a few pixels are drawn as one texel each, as the circles and lines would not show anyway
+        const bool pixel_mode = m_board_sizes.grid_square < c_pixel_mode_square;
+        if (pixel_mode) {
+            update_board_pixels();
+        }
+        else {
+            update_board_layer();
+            update_lines_layer();
+        }
 
         BeginDrawing();
         ClearBackground(LIGHTGRAY);
-        draw_background();
-        draw_history_lines();
-        draw_barriers();
-        if (m_game.start_pos().has_value()) {
-            draw_start_circle();
+        if (pixel_mode) {
+            draw_board_pixels();
         }
-        if (m_game.current_pos().has_value()) {
-            draw_current_pos_circle();
+        else {
+            draw_layer(m_board_layer);
+            draw_layer(m_lines_layer);
+            if (m_game.start_pos().has_value()) {
+                draw_start_circle();
+            }
+            if (m_game.current_pos().has_value()) {
+                draw_current_pos_circle();
+            }
         }
         draw_and_update_ui();
         EndDrawing();
@@ -68,7 +92,7 @@ private:
     void update_game()
     {
         if (IsWindowResized()) {
-            m_board_sizes = calc_board_sizes();
+            update_board_sizes();
         }
         if (m_state == GameState::manual) {
             update_manual();
@@ -78,86 +102,288 @@ private:
         }
     }
 
-    void draw_background_square(const int x, const int y) const
+    // The cell drawing functions take the top left corner of the board, which is at the origin inside the board layer
+    void draw_background_square(const Vector2 origin, const int x, const int y) const
     {
         const Vector2i rect_pos { static_cast<int>(
-                                      m_board_sizes.offset.x + m_board_sizes.square_padding
+                                      origin.x + m_board_sizes.square_padding
                                       + static_cast<float>(x) * m_board_sizes.grid_square),
                                   static_cast<int>(
-                                      m_board_sizes.offset.y + m_board_sizes.square_padding
+                                      origin.y + m_board_sizes.square_padding
                                       + static_cast<float>(y) * m_board_sizes.grid_square) };
         const int rect_size = static_cast<int>(m_board_sizes.inner_square);
         DrawRectangle(rect_pos.x, rect_pos.y, rect_size, rect_size, raylib::Color(168, 168, 168));
     }
 
-    void draw_filled_circle(const int x, const int y) const
+    void draw_cell_circle(const Vector2 origin, const int x, const int y, const Color color) const
     {
         const Vector2i circle_pos {
             static_cast<int>(
-                m_board_sizes.offset.x + m_board_sizes.grid_square / 2
-                + static_cast<float>(x) * m_board_sizes.grid_square),
+                origin.x + m_board_sizes.grid_square / 2 + static_cast<float>(x) * m_board_sizes.grid_square),
             static_cast<int>(
-                m_board_sizes.offset.y + m_board_sizes.grid_square / 2
-                + static_cast<float>(y) * m_board_sizes.grid_square)
+                origin.y + m_board_sizes.grid_square / 2 + static_cast<float>(y) * m_board_sizes.grid_square)
         };
         const float circle_radius = m_board_sizes.inner_square / 2;
-        const Color circle_color = m_game.result().has_value()
-            ? m_game.result().value() == FullBoardGame::Result::won ? DARKGREEN : RED
-            : GRAY;
-        DrawCircle(circle_pos.x, circle_pos.y, circle_radius, circle_color);
+        DrawCircle(circle_pos.x, circle_pos.y, circle_radius, color);
     }
 
-    void draw_background() const
+    // The background square of a cell with its barrier or filled circle over it, which covers whatever was drawn there
+    void draw_board_cell(const Vector2 origin, const int x, const int y) const
     {
-        for (int x = 0; x < m_game.size(); ++x) {
-            for (int y = 0; y < m_game.size(); ++y) {
-                draw_background_square(x, y);
-                if (m_game.filled_at({ x, y })) {
-                    draw_filled_circle(x, y);
+        draw_background_square(origin, x, y);
+        if (m_game.barrier_at({ x, y })) {
+            draw_cell_circle(origin, x, y, BLACK);
+        }
+        else if (m_game.filled_at({ x, y })) {
+            const Color circle_color = m_game.result().has_value()
+                ? m_game.result().value() == FullBoardGame::Result::won ? DARKGREEN : RED
+                : GRAY;
+            draw_cell_circle(origin, x, y, circle_color);
+        }
+    }
+
+    // Brings the cached layer of cells and barriers up to date with the game. Only the cells whose filled state changed
+    // since the last frame are drawn again, along with the filled cells when the result changed their circle colors,
+    // unless the board was resized.
+    void update_board_layer()
+    {
+        const std::span<const uint64_t> rows = m_game.filled_rows();
+        if (!m_board_layer_valid || m_board_layer_rows.size() != rows.size()) {
+            fit_layer(m_board_layer);
+            BeginTextureMode(m_board_layer);
+            ClearBackground(LIGHTGRAY);
+            for (int x = 0; x < m_game.size(); ++x) {
+                for (int y = 0; y < m_game.size(); ++y) {
+                    draw_board_cell({ 0.0f, 0.0f }, x, y);
                 }
             }
+            EndTextureMode();
+        }
+        else {
+            const int words = line_words(m_game.size());
+            const bool recolor = m_board_layer_result != m_game.result();
+            bool drawing = false;
+            for (size_t i = 0; i < rows.size(); ++i) {
+                const uint64_t toggled = rows[i] ^ m_board_layer_rows[i];
+                // Cells filled in both frames, which includes barriers and the padding past the end of the line
+                const uint64_t kept = recolor ? rows[i] & m_board_layer_rows[i] : 0;
+                for (uint64_t changed = toggled | kept; changed != 0; changed &= changed - 1) {
+                    const int bit = std::countr_zero(changed);
+                    const Vector2i pos { static_cast<int>(i) % words * 64 + bit, static_cast<int>(i) / words };
+                    if ((toggled >> bit & 1) == 0 && (pos.x >= m_game.size() || m_game.barrier_at(pos))) {
+                        continue;
+                    }
+                    if (!drawing) {
+                        BeginTextureMode(m_board_layer);
+                        drawing = true;
+                    }
+                    draw_board_cell({ 0.0f, 0.0f }, pos.x, pos.y);
+                }
+            }
+            if (drawing) {
+                EndTextureMode();
+            }
+        }
+        m_board_layer_rows.assign(rows.begin(), rows.end());
+        m_board_layer_result = m_game.result();
+        m_board_layer_valid = true;
+    }
+
+    [[nodiscard]] Vector2 cell_center(const Vector2 origin, const Vector2i pos) const
+    {
+        return { origin.x + m_board_sizes.grid_square / 2.0f + static_cast<float>(pos.x) * m_board_sizes.grid_square,
+                 origin.y + m_board_sizes.grid_square / 2.0f + static_cast<float>(pos.y) * m_board_sizes.grid_square };
+    }
+
+    void draw_history_line(const Vector2 origin, const FullBoardGame::MoveRecord& move) const
+    {
+        DrawLineEx(cell_center(origin, move.from), cell_center(origin, move.to), c_line_thickness, BLUE);
+    }
+
+    // Pixels of the board layers a history line can touch
+    [[nodiscard]] Rectangle history_line_bounds(const FullBoardGame::MoveRecord& move) const
+    {
+        const Vector2 from = cell_center({ 0.0f, 0.0f }, move.from);
+        const Vector2 to = cell_center({ 0.0f, 0.0f }, move.to);
+        constexpr float margin = c_line_thickness / 2.0f + 1.0f;
+        return { std::min(from.x, to.x) - margin,
+                 std::min(from.y, to.y) - margin,
+                 std::abs(to.x - from.x) + 2 * margin,
+                 std::abs(to.y - from.y) + 2 * margin };
+    }
+
+    // Brings the cached layer of history lines up to date with the game. Lines of moves no longer on the path are
+    // erased, the lines they overlapped are drawn again, and new moves are drawn on top, so a frame only draws the
+    // lines that changed rather than the whole path.
+    void update_lines_layer()
+    {
+        const std::span<const FullBoardGame::PackedMove> moves = m_game.move_history().packed();
+        const size_t kept = m_lines_layer_valid
+            ? static_cast<size_t>(std::ranges::mismatch(m_lines_layer_moves, moves).in1 - m_lines_layer_moves.begin())
+            : 0;
+        if (m_lines_layer_valid && kept == m_lines_layer_moves.size() && kept == moves.size()) {
+            return;
+        }
+        if (!m_lines_layer_valid) {
+            fit_layer(m_lines_layer);
+        }
+        BeginTextureMode(m_lines_layer);
+        if (kept == 0) {
+            ClearBackground(BLANK);
+        }
+        else if (kept < m_lines_layer_moves.size()) {
+            erase_history_lines(kept);
+        }
+        for (size_t i = kept; i < moves.size(); ++i) {
+            draw_history_line({ 0.0f, 0.0f }, moves[i].unpack(m_game.size()));
+        }
+        EndTextureMode();
+        const auto kept_end = static_cast<std::ptrdiff_t>(kept);
+        m_lines_layer_moves.erase(m_lines_layer_moves.begin() + kept_end, m_lines_layer_moves.end());
+        m_lines_layer_moves.insert(m_lines_layer_moves.end(), moves.begin() + kept_end, moves.end());
+        m_lines_layer_valid = true;
+    }
+
+    // Clears the lines of the moves drawn after the first `kept` from the lines layer, then draws again the kept lines
+    // that shared pixels with them
+    void erase_history_lines(const size_t kept)
+    {
+        std::vector<Rectangle> erased;
+        // Writes the transparent color as is rather than blending it in
+        rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM);
+        for (size_t i = kept; i < m_lines_layer_moves.size(); ++i) {
+            erased.push_back(history_line_bounds(m_lines_layer_moves[i].unpack(m_game.size())));
+            DrawRectangleRec(erased.back(), BLANK);
+        }
+        EndBlendMode();
+        for (size_t i = 0; i < kept; ++i) {
+            const FullBoardGame::MoveRecord move = m_lines_layer_moves[i].unpack(m_game.size());
+            const Rectangle bounds = history_line_bounds(move);
+            if (std::ranges::any_of(erased, [&](const Rectangle& r) { return CheckCollisionRecs(bounds, r); })) {
+                draw_history_line({ 0.0f, 0.0f }, move);
+            }
+        }
+    }
+
+    // Pixel of a cell for the pixel buffer. Cells on the path take the color of the result once there is one.
+    [[nodiscard]] Color cell_pixel(const Vector2i pos) const
+    {
+        if (m_game.barrier_at(pos)) {
+            return BLACK;
         }
+        if (m_game.current_pos() == pos) {
+            return DARKBLUE;
+        }
+        if (!m_game.filled_at(pos)) {
+            return c_empty_pixel;
+        }
+        return m_game.result().has_value() ? m_game.result().value() == FullBoardGame::Result::won ? DARKGREEN : RED
+                                           : BLUE;
     }
 
-    void draw_history_lines() const
+    // Brings the pixel buffer, one pixel per cell, and its texture up to date with the game. As with the board layer,
+    // only the cells whose filled state changed and the old and new current cell are written, unless the board size or
+    // the result changed, and only the band of rows holding them is uploaded. A frame with no change uploads nothing.
+    void update_board_pixels()
     {
-        for (auto [dir, from, to] : m_game.move_history()) {
-            const Vector2 start { m_board_sizes.offset.x + m_board_sizes.grid_square / 2.0f
-                                      + static_cast<float>(from.x) * m_board_sizes.grid_square,
-                                  m_board_sizes.offset.y + m_board_sizes.grid_square / 2.0f
-                                      + static_cast<float>(from.y) * m_board_sizes.grid_square };
-            const Vector2 end { m_board_sizes.offset.x + m_board_sizes.grid_square / 2.0f
-                                    + static_cast<float>(to.x) * m_board_sizes.grid_square,
-                                m_board_sizes.offset.y + m_board_sizes.grid_square / 2.0f
-                                    + static_cast<float>(to.y) * m_board_sizes.grid_square };
-            DrawLineEx(start, end, 5.0f, BLUE);
+        const int size = m_game.size();
+        const std::span<const uint64_t> rows = m_game.filled_rows();
+        const std::optional<Vector2i> pos = m_game.current_pos();
+        const bool redraw_all = m_board_texture.width != size || m_board_pixels_result != m_game.result()
+            || m_board_pixels_rows.size() != rows.size();
+        if (m_board_texture.width != size) {
+            m_board_pixels.assign(static_cast<size_t>(size) * size, c_empty_pixel);
+            m_board_texture = RTexture(RImage(size, size, c_empty_pixel));
+        }
+        int first_line = size;
+        int last_line = -1;
+        const auto write_pixel = [&](const Vector2i cell) {
+            m_board_pixels[static_cast<size_t>(cell.y) * size + cell.x] = cell_pixel(cell);
+            first_line = std::min(first_line, cell.y);
+            last_line = std::max(last_line, cell.y);
+        };
+        if (redraw_all) {
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    write_pixel({ x, y });
+                }
+            }
         }
+        else {
+            const int words = line_words(size);
+            for (size_t i = 0; i < rows.size(); ++i) {
+                for (uint64_t changed = rows[i] ^ m_board_pixels_rows[i]; changed != 0; changed &= changed - 1) {
+                    const int x = static_cast<int>(i) % words * 64 + std::countr_zero(changed);
+                    write_pixel({ x, static_cast<int>(i) / words });
+                }
+            }
+            if (pos != m_board_pixels_pos) {
+                if (m_board_pixels_pos.has_value()) {
+                    write_pixel(*m_board_pixels_pos);
+                }
+                if (pos.has_value()) {
+                    write_pixel(*pos);
+                }
+            }
+        }
+        if (first_line <= last_line) {
+            const Rectangle band { 0.0f,
+                                   static_cast<float>(first_line),
+                                   static_cast<float>(size),
+                                   static_cast<float>(last_line - first_line + 1) };
+            UpdateTextureRec(m_board_texture, band, m_board_pixels.data() + static_cast<size_t>(first_line) * size);
+        }
+        m_board_pixels_rows.assign(rows.begin(), rows.end());
+        m_board_pixels_result = m_game.result();
+        m_board_pixels_pos = pos;
+    }
+
+    void draw_board_pixels() const
+    {
+        const auto size = static_cast<float>(m_game.size());
+        const Vector2 origin = layer_origin();
+        DrawTexturePro(
+            m_board_texture,
+            { 0.0f, 0.0f, size, size },
+            { origin.x, origin.y, size * m_board_sizes.grid_square, size * m_board_sizes.grid_square },
+            { 0.0f, 0.0f },
+            0.0f,
+            WHITE);
     }
 
-    void draw_barriers() const
+    // Gives `layer` the size of the board, leaving it as it was if it already has it
+    void fit_layer(RRenderTexture& layer) const
     {
-        for (const auto [x, y] : m_game.barrier_positions()) {
-            const Vector2i circle_pos {
-                static_cast<int>(
-                    m_board_sizes.offset.x + m_board_sizes.grid_square / 2
-                    + static_cast<float>(x) * m_board_sizes.grid_square),
-                static_cast<int>(
-                    m_board_sizes.offset.y + m_board_sizes.grid_square / 2
-                    + static_cast<float>(y) * m_board_sizes.grid_square)
-            };
-            const float circle_radius = m_board_sizes.inner_square / 2;
-            DrawCircle(circle_pos.x, circle_pos.y, circle_radius, BLACK);
+        const int side = static_cast<int>(std::ceil(m_board_sizes.board_rect.width));
+        if (layer.texture.width != side) {
+            layer = RRenderTexture(side, side);
         }
     }
 
+    // Top left corner of the board on screen, snapped to a whole pixel so that the layers are drawn texel for texel.
+    // Everything else drawn on the board or picked from it uses the same corner, so it lines up with the layers.
+    [[nodiscard]] Vector2 layer_origin() const
+    {
+        return { std::floor(m_board_sizes.offset.x), std::floor(m_board_sizes.offset.y) };
+    }
+
+    void draw_layer(const RRenderTexture& layer) const
+    {
+        const auto side = static_cast<float>(layer.texture.width);
+        // Render textures are stored upside down
+        DrawTextureRec(layer.texture, { 0.0f, 0.0f, side, -side }, layer_origin(), WHITE);
+    }
+
     void draw_start_circle() const
     {
+        const Vector2 origin = layer_origin();
         const Vector2i circle_pos {
             static_cast<int>(
-                m_board_sizes.offset.x + m_board_sizes.grid_square / 2
+                origin.x + m_board_sizes.grid_square / 2
                 + static_cast<float>(m_game.start_pos()->x) * m_board_sizes.grid_square),
             static_cast<int>(
-                m_board_sizes.offset.y + m_board_sizes.grid_square / 2
+                origin.y + m_board_sizes.grid_square / 2
                 + static_cast<float>(m_game.start_pos()->y) * m_board_sizes.grid_square)
         };
         const float circle_radius = m_board_sizes.inner_square / 4;
@@ -166,16 +392,14 @@ private:
 
     void draw_current_pos_circle() const
     {
-        const Vector2i circle_pos {
-            static_cast<int>(
-                m_board_sizes.offset.x + m_board_sizes.grid_square / 2
-                + static_cast<float>(m_game.current_pos()->x) * m_board_sizes.grid_square),
-            static_cast<int>(
-                m_board_sizes.offset.y + m_board_sizes.grid_square / 2
-                + static_cast<float>(m_game.current_pos()->y) * m_board_sizes.grid_square)
-        };
-        const float circle_radius = m_board_sizes.inner_square / 2;
-        DrawCircle(circle_pos.x, circle_pos.y, circle_radius, BLUE);
+        draw_cell_circle(layer_origin(), m_game.current_pos()->x, m_game.current_pos()->y, BLUE);
+    }
+
+    void update_board_sizes()
+    {
+        m_board_sizes = calc_board_sizes();
+        m_board_layer_valid = false;
+        m_lines_layer_valid = false;
     }
 
     [[nodiscard]] BoardSizes calc_board_sizes() const
@@ -199,9 +423,9 @@ private:
         if (!CheckCollisionPointRec(mouse_pos, m_board_sizes.board_rect)) {
             return std::nullopt;
         }
-        if (const Vector2i grid_pos
-            = { static_cast<int>((mouse_pos.x - m_board_sizes.offset.x) / m_board_sizes.grid_square),
-                static_cast<int>((mouse_pos.y - m_board_sizes.offset.y) / m_board_sizes.grid_square) };
+        const Vector2 origin = layer_origin();
+        if (const Vector2i grid_pos = { static_cast<int>((mouse_pos.x - origin.x) / m_board_sizes.grid_square),
+                                        static_cast<int>((mouse_pos.y - origin.y) / m_board_sizes.grid_square) };
             m_game.in_bounds(grid_pos)) {
             return grid_pos;
         }
@@ -248,12 +472,17 @@ private:
         };
 
         if (next_button("[C] Clear")) {
+            stop_solving();
             m_game.reset();
+            m_solver_stats = {};
         }
         if (next_button("[R] Restart")) {
+            stop_solving();
             m_game.reset_leave_barriers();
+            m_solver_stats = {};
         }
         if (next_button("[U] Undo")) {
+            stop_solving();
             m_game.undo();
         }
         x_offset += 20.0f;
@@ -279,10 +508,55 @@ private:
         GuiCheckBox({ x_offset, y_offset, button_size.y, button_size.y }, draw_barrier_text, &m_draw_barriers);
         x_offset += button_size.y + text_width(draw_barrier_text) + ui_padding + 20.0f;
         if (next_button("[S] Solve Step", 120.0f)) {
-            auto_solve_update(m_game, std::nullopt);
+            stop_solving();
+            auto_solve_update(m_game, std::nullopt, m_solver_config, m_solver_stats);
         }
         if (next_button("[Q] Quick Solve", 120.0f)) {
-            m_state = GameState::solving;
+            if (m_state == GameState::solving) {
+                stop_solving();
+            }
+            else {
+                start_solving();
+            }
+        }
+        if (m_solver_stats.starts_tried > 0) {
+            draw_solver_stats();
+        }
+    }
+
+    // Live counters of the solve so far, over the top left corner of the board
+    void draw_solver_stats() const
+    {
+        const SolverStats& stats = m_solver_stats;
+        std::ostringstream elapsed;
+        elapsed << std::fixed << std::setprecision(2) << std::chrono::duration<double>(stats.elapsed).count() << " s";
+        const std::array<std::string, 6> lines {
+            "Nodes: " + std::to_string(stats.nodes) + " ("
+                + std::to_string(static_cast<uint64_t>(stats.nodes_per_second())) + "/s)",
+            "Undos: " + std::to_string(stats.undos),
+            "Starts tried: " + std::to_string(stats.starts_tried),
+            "Max depth: " + std::to_string(stats.max_depth),
+            "Pruned: " + std::to_string(stats.pruned_degrees) + " degrees, " + std::to_string(stats.pruned_table)
+                + " table, " + std::to_string(stats.pruned_connectivity) + " connectivity",
+            "Elapsed: " + elapsed.str(),
+        };
+        constexpr float padding = 6.0f;
+        constexpr float line_height = c_font_size + 2.0f;
+        float width = 0.0f;
+        for (const std::string& line : lines) {
+            width = std::max(width, text_width(line));
+        }
+        const Vector2 pos { m_board_sizes.offset.x + padding, m_board_sizes.offset.y + padding };
+        DrawRectangleRec(
+            { pos.x, pos.y, width + 2 * padding, static_cast<float>(lines.size()) * line_height + 2 * padding },
+            Fade(RAYWHITE, 0.85f));
+        for (size_t i = 0; i < lines.size(); ++i) {
+            m_ui_font.DrawText(
+                lines[i],
+                Vector2 { pos.x + padding, pos.y + padding + static_cast<float>(i) * line_height },
+                c_font_size,
+                1.0f,
+                DARKGRAY);
         }
     }
 
@@ -290,9 +564,11 @@ private:
     {
         if (IsKeyPressed(KEY_C)) {
             m_game.reset();
+            m_solver_stats = {};
         }
         else if (IsKeyPressed(KEY_R)) {
             m_game.reset_leave_barriers();
+            m_solver_stats = {};
         }
 
         if (IsKeyPressed(KEY_U)) {
@@ -306,6 +582,7 @@ private:
             else if (m_draw_barriers) {
                 if (const std::optional<Vector2i> grid_pos = mouse_to_grid(); grid_pos.has_value()) {
                     m_game.toggle_barrier(*grid_pos);
+                    m_solver_stats = {};
                 }
             }
         }
@@ -313,14 +590,15 @@ private:
         if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
             if (const std::optional<Vector2i> grid_pos = mouse_to_grid(); grid_pos.has_value()) {
                 m_game.toggle_barrier(*grid_pos);
+                m_solver_stats = {};
             }
         }
 
         if (IsKeyPressed(KEY_S)) {
-            auto_solve_update(m_game, std::nullopt);
+            auto_solve_update(m_game, std::nullopt, m_solver_config, m_solver_stats);
         }
         if (IsKeyPressed(KEY_Q)) {
-            m_state = GameState::solving;
+            start_solving();
         }
 
         if (IsKeyPressed(KEY_RIGHT)) {
@@ -331,20 +609,54 @@ private:
         }
     }
 
+    void start_solving()
+    {
+        m_solver.emplace(m_game, m_solver_config, m_solver_stats);
+        m_state = GameState::solving;
+    }
+
+    // Shows the newest position the solver has published, and goes back to manual play once it stops
     void update_solving()
     {
-        if (IsKeyPressed(KEY_Q)
-            || auto_solve_update(m_game, std::chrono::milliseconds(16)) == AutoSolveResult::should_stop) {
+        if (IsKeyPressed(KEY_Q)) {
+            stop_solving();
+            return;
+        }
+        if (m_solver->poll()) {
+            take_snapshot();
+        }
+        if (m_solver->snapshot().finished) {
+            m_solver.reset();
             m_state = GameState::manual;
         }
     }
 
+    // Cancels a running solve, keeping where it got to so the next one carries on from there
+    void stop_solving()
+    {
+        if (m_state != GameState::solving) {
+            return;
+        }
+        m_solver->cancel();
+        m_solver->poll();
+        take_snapshot();
+        m_solver.reset();
+        m_state = GameState::manual;
+    }
+
+    void take_snapshot()
+    {
+        m_game = m_solver->snapshot().game;
+        m_solver_stats = m_solver->snapshot().stats;
+    }
+
     void set_game_size(int new_size)
     {
         if (m_state == GameState::manual) {
             new_size = std::clamp(new_size, 1, 100);
             m_game = FullBoardGame(new_size);
-            m_board_sizes = calc_board_sizes();
+            m_solver_stats = {};
+            update_board_sizes();
         }
     }
 
@@ -354,12 +666,37 @@ private:
     }
 
     static constexpr int c_font_size = 16;
+    static constexpr float c_line_thickness = 5.0f;
+    // Grid squares smaller than this many pixels switch to drawing the board from the pixel buffer
+    static constexpr float c_pixel_mode_square = 6.0f;
+    static constexpr Color c_empty_pixel { 168, 168, 168, 255 };
     static constexpr Vector2i c_init_window_size = { 800, 800 };
     RWindow m_window;
     RFont m_ui_font;
     FullBoardGame m_game;
+    SolverConfig m_solver_config {
+        .prune_degrees = true, .prune_connectivity = true, .reduce_symmetry = true, .constrain_endpoints = true
+    };
+    SolverStats m_solver_stats;
     BoardSizes m_board_sizes;
+    // Cells and barriers as last drawn into the board layer
+    RRenderTexture m_board_layer;
+    std::vector<uint64_t> m_board_layer_rows;
+    std::optional<FullBoardGame::Result> m_board_layer_result;
+    bool m_board_layer_valid = false;
+    // History lines as last drawn into the lines layer, for the moves held here
+    RRenderTexture m_lines_layer;
+    std::vector<FullBoardGame::PackedMove> m_lines_layer_moves;
+    bool m_lines_layer_valid = false;
+    // One pixel per cell, for boards too fine for the layers, and the game state it was last written from
+    std::vector<Color> m_board_pixels;
+    RTexture m_board_texture;
+    std::vector<uint64_t> m_board_pixels_rows;
+    std::optional<FullBoardGame::Result> m_board_pixels_result;
+    std::optional<Vector2i> m_board_pixels_pos;
     GameState m_state;
+    // Set while the state is solving
+    std::optional<BackgroundSolver> m_solver;
     bool m_size_edit_mode;
     bool m_draw_barriers;
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "full_board_solver.hpp"
+#include "triple_buffer.hpp"
+
+// State of a background solve as last published
+struct SolveSnapshot {
+    FullBoardGame game;
+    SolverStats stats;
+    // Whether the solve stopped by itself, because it won or ran out of start cells
+    bool finished = false;
+};
+
+// Runs auto_solve_update on a copy of a game from a worker thread until it stops or is cancelled, publishing the game
+// and stats about once a frame from its progress callback. The thread that made it reads them with poll() and
+// snapshot() and never waits on the worker, except in cancel(), which the worker sees within a move. The web build has
+// no threads, so there poll() runs one frame's slice of the solve itself.
+class BackgroundSolver {
+public:
+    BackgroundSolver(const FullBoardGame& game, const SolverConfig& config, const SolverStats& stats)
+        : m_game(game)
+        , m_config(config)
+        , m_stats(stats)
+        , m_snapshots(SolveSnapshot { .game = game, .stats = stats, .finished = false })
+    {
+#ifndef PLATFORM_WEB
+        m_thread = std::thread([this] { run(); });
+#endif
+    }
+
+    BackgroundSolver(const BackgroundSolver&) = delete;
+    BackgroundSolver& operator=(const BackgroundSolver&) = delete;
+
+    ~BackgroundSolver()
+    {
+        cancel();
+    }
+
+    // Stops the solve and waits for the worker to publish where it got to, which poll() then picks up
+    void cancel()
+    {
+        m_cancel.store(true, std::memory_order_relaxed);
+#ifndef PLATFORM_WEB
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+#endif
+    }
+
+    // Takes the newest snapshot the worker has published, if any since the last call. Returns whether there was one.
+    bool poll()
+    {
+#ifdef PLATFORM_WEB
+        if (!m_cancel.load(std::memory_order_relaxed) && !m_snapshots.front().finished) {
+            SolveLimits limits;
+            limits.deadline = std::chrono::steady_clock::now() + c_publish_interval;
+            publish(auto_solve_update(m_game, limits, m_config, m_stats) == AutoSolveResult::should_stop, m_stats);
+        }
+#endif
+        return m_snapshots.acquire();
+    }
+
+    [[nodiscard]] const SolveSnapshot& snapshot() const
+    {
+        return m_snapshots.front();
+    }
+
+private:
+    static constexpr std::chrono::milliseconds c_publish_interval { 16 };
+
+    void publish(const bool finished, const SolverStats& stats)
+    {
+        SolveSnapshot& back = m_snapshots.back();
+        back.game = m_game;
+        back.stats = stats;
+        back.finished = finished;
+        m_snapshots.publish();
+    }
+
+    void run()
+    {
+        SolveLimits limits;
+        limits.stop = &m_cancel;
+        limits.on_progress = [this](const SolverStats& stats) { publish(false, stats); };
+        limits.progress_interval = c_publish_interval;
+        publish(auto_solve_update(m_game, limits, m_config, m_stats) == AutoSolveResult::should_stop, m_stats);
+    }
+
+    // Owned by the worker while it runs
+    FullBoardGame m_game;
+    SolverConfig m_config;
+    SolverStats m_stats;
+    TripleBuffer<SolveSnapshot> m_snapshots;
+    std::atomic<bool> m_cancel = false;
+#ifndef PLATFORM_WEB
+    std::thread m_thread;
+#endif
+};
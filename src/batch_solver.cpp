@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <BS_thread_pool.hpp>
+
+#include "board_io.hpp"
+#include "full_board_solver.hpp"
+#include "parallel_solver.hpp"
+#include "small_board_solver.hpp"
+#include "solution_counter.hpp"
+#include "work_stealing_solver.hpp"
+
+// What the threads of the pool share out
+enum class Split {
+    // Whole boards, each solved on one thread with solve_by_size
+    boards,
+    // The start cells of one board at a time, with parallel_solve
+    starts,
+    // The search tree of one board at a time, with work_stealing_solve
+    steal,
+};
+
+struct BatchOptions {
+    const char* input_path = nullptr;
+    const char* output_path = nullptr;
+    // Per board, with none meaning no limit
+    std::optional<std::chrono::milliseconds> time_limit;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    Split split = Split::boards;
+    // Time to count every solution of each board in, after it is solved, with none meaning no count
+    std::optional<std::chrono::milliseconds> count_limit;
+};
+
+enum class Outcome { solved, unsolvable, timeout, invalid };
+
+struct BoardResult {
+    Outcome outcome = Outcome::invalid;
+    std::string board;
+    std::string solution;
+    uint64_t nodes = 0;
+    uint64_t steals = 0;
+    double milliseconds = 0.0;
+    std::optional<SolutionCount> count;
+};
+
+static void print_usage()
+{
+    std::cerr << "Usage: batch_solver <board file> <output file> [--time-limit ms] [--threads n]\n"
+                 "                    [--split boards|starts|steal] [--count ms]\n";
+}
+
+static std::optional<BatchOptions> parse_options(const int argc, char** argv)
+{
+    if (argc < 3 || (argc - 3) % 2 != 0) {
+        return std::nullopt;
+    }
+    BatchOptions options;
+    options.input_path = argv[1];
+    options.output_path = argv[2];
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const std::string_view flag = argv[i];
+        bool valid = false;
+        if (flag == "--time-limit") {
+            int64_t milliseconds = 0;
+            valid = parse_number(argv[i + 1], milliseconds) && milliseconds > 0;
+            if (valid) {
+                options.time_limit = std::chrono::milliseconds(milliseconds);
+            }
+        }
+        else if (flag == "--threads") {
+            valid = parse_number(argv[i + 1], options.threads) && options.threads > 0;
+        }
+        else if (flag == "--split") {
+            const std::string_view split = argv[i + 1];
+            valid = split == "boards" || split == "starts" || split == "steal";
+            options.split = split == "starts" ? Split::starts : split == "steal" ? Split::steal : Split::boards;
+        }
+        else if (flag == "--count") {
+            int64_t milliseconds = 0;
+            valid = parse_number(argv[i + 1], milliseconds) && milliseconds > 0;
+            if (valid) {
+                options.count_limit = std::chrono::milliseconds(milliseconds);
+            }
+        }
+        if (!valid) {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+static const char* outcome_name(const Outcome outcome)
+{
+    switch (outcome) {
+    case Outcome::solved:
+        return "solved";
+    case Outcome::unsolvable:
+        return "unsolvable";
+    case Outcome::timeout:
+        return "timeout";
+    default:
+        return "invalid";
+    }
+}
+
+static Outcome to_outcome(const SolveOutcome outcome)
+{
+    switch (outcome) {
+    case SolveOutcome::solved:
+        return Outcome::solved;
+    case SolveOutcome::unsolvable:
+        return Outcome::unsolvable;
+    default:
+        return Outcome::timeout;
+    }
+}
+
+// Solves the board on `line` on this thread with Split::boards, and otherwise shares it out on `pool` as the options
+// say. The solutions are counted on this thread.
+static BoardResult solve_board(
+    const std::string_view line, const BatchOptions& options, const SolverConfig& config, BS::thread_pool& pool)
+{
+    BoardResult result;
+    const std::optional<BoardSpec> spec = parse_board_line(line);
+    if (!spec.has_value()) {
+        result.board = line;
+        return result;
+    }
+    const auto start_time = std::chrono::steady_clock::now();
+    FullBoardGame game(spec->size);
+    game.set_barriers(spec->barriers);
+    result.board = format_board(game.size(), game.barrier_positions());
+    SolverStats stats;
+    SolveLimits limits;
+    if (options.time_limit.has_value()) {
+        limits.deadline = start_time + *options.time_limit;
+    }
+    if (options.split == Split::starts) {
+        result.outcome = to_outcome(parallel_solve(game, pool, config, stats, limits));
+    }
+    else if (options.split == Split::steal) {
+        std::vector<WorkerStats> worker_stats;
+        result.outcome = to_outcome(work_stealing_solve(game, pool, config, stats, worker_stats, limits));
+        for (const WorkerStats& worker : worker_stats) {
+            result.steals += worker.steals;
+        }
+    }
+    else {
+        result.outcome = to_outcome(solve_by_size(game, config, stats, limits));
+    }
+    if (result.outcome == Outcome::solved) {
+        result.solution = format_solution(*game.start_pos(), game.move_history());
+    }
+    result.nodes = stats.nodes;
+    result.milliseconds
+        = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    if (options.count_limit.has_value()) {
+        SolveLimits count_limits;
+        count_limits.deadline = std::chrono::steady_clock::now() + *options.count_limit;
+        result.count = count_solutions(game, config, count_limits);
+    }
+    return result;
+}
+
+int main(const int argc, char** argv)
+{
+    const std::optional<BatchOptions> options = parse_options(argc, argv);
+    if (!options.has_value()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    std::ifstream input(options->input_path);
+    if (!input) {
+        std::cerr << "Cannot open " << options->input_path << " for reading\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(input, line);) {
+        // Blank and comment-only lines are not boards
+        if (const size_t first = line.find_first_not_of(" \t\r"); first != std::string::npos && line[first] != '#') {
+            lines.push_back(std::move(line));
+        }
+    }
+    std::ofstream output(options->output_path);
+    if (!output) {
+        std::cerr << "Cannot open " << options->output_path << " for writing\n";
+        return EXIT_FAILURE;
+    }
+
+    // A dead position is keyed by its filled cells, current position and board size, so boards of every size can share
+    // one table
+    TranspositionTable table(1 << 22);
+    const SolverConfig config { .prune_degrees = true,
+                                .prune_connectivity = true,
+                                .table = &table,
+                                .reduce_symmetry = true,
+                                .constrain_endpoints = true };
+    std::vector<BoardResult> results(lines.size());
+    const auto start_time = std::chrono::steady_clock::now();
+    BS::thread_pool pool(options->threads);
+    if (options->split == Split::boards) {
+        BS::multi_future<void> tasks = pool.submit_sequence<size_t>(0, lines.size(), [&](const size_t i) {
+            results[i] = solve_board(lines[i], *options, config, pool);
+        });
+        tasks.wait();
+    }
+    else {
+        for (size_t i = 0; i < lines.size(); ++i) {
+            results[i] = solve_board(lines[i], *options, config, pool);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::vector<size_t> outcome_counts(4);
+    uint64_t steals = 0;
+    for (const BoardResult& result : results) {
+        outcome_counts[static_cast<size_t>(result.outcome)]++;
+        steals += result.steals;
+        output << result.board << " # " << outcome_name(result.outcome) << " nodes " << result.nodes << " ms "
+               << result.milliseconds;
+        if (result.outcome == Outcome::solved) {
+            output << " solution " << result.solution;
+        }
+        if (result.count.has_value()) {
+            output << " solutions " << (result.count->complete ? "" : "at least ") << result.count->total;
+        }
+        output << '\n';
+    }
+    std::cerr << results.size() << " boards in " << seconds << " s (" << static_cast<double>(results.size()) / seconds
+              << " boards/s): ";
+    for (size_t i = 0; i < outcome_counts.size(); ++i) {
+        std::cerr << (i > 0 ? ", " : "") << outcome_counts[i] << ' ' << outcome_name(static_cast<Outcome>(i));
+    }
+    if (options->split == Split::steal) {
+        std::cerr << ", " << steals << " steals";
+    }
+    std::cerr << '\n';
+    return EXIT_SUCCESS;
+}
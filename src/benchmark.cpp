@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "board_io.hpp"
+#include "iterative_solver.hpp"
+#include "small_board_solver.hpp"
+
+// Results are printed one JSON object per line on stdout, so runs from two revisions can be diffed or loaded directly.
+// Micro benchmarks report nanoseconds per operation over several samples, and solve benchmarks report each board's
+// median time and nodes, then the nodes per second and the percentiles of the time per solve over the corpus.
+
+struct BenchmarkOptions {
+    const char* corpus_path = nullptr;
+    // Solves of each board, of which the median time is kept
+    int repeat = 3;
+    // Timed samples of each micro benchmark
+    int samples = 15;
+};
+
+struct CorpusBoard {
+    BoardSpec spec;
+    bool solvable;
+};
+
+struct Percentiles {
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+// Receives results nothing else reads, so the compiler can't drop the work that made them
+static volatile uint64_t g_sink;
+
+static void print_usage()
+{
+    std::cerr << "Usage: solver_benchmark <corpus file> [--repeat n] [--samples n]\n";
+}
+
+static std::optional<BenchmarkOptions> parse_options(const int argc, char** argv)
+{
+    if (argc < 2 || (argc - 2) % 2 != 0) {
+        return std::nullopt;
+    }
+    BenchmarkOptions options;
+    options.corpus_path = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string_view flag = argv[i];
+        bool valid = false;
+        if (flag == "--repeat") {
+            valid = parse_number(argv[i + 1], options.repeat) && options.repeat > 0;
+        }
+        else if (flag == "--samples") {
+            valid = parse_number(argv[i + 1], options.samples) && options.samples > 0;
+        }
+        if (!valid) {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+// Every board of the corpus with the outcome its comment expects, or nullopt if a line doesn't parse
+static std::optional<std::vector<CorpusBoard>> load_corpus(const char* path)
+{
+    std::ifstream input(path);
+    if (!input) {
+        return std::nullopt;
+    }
+    std::vector<CorpusBoard> corpus;
+    for (std::string line; std::getline(input, line);) {
+        if (const size_t first = line.find_first_not_of(" \t\r"); first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        const size_t comment = line.find('#');
+        const std::optional<BoardSpec> spec = parse_board_line(line);
+        if (!spec.has_value() || comment == std::string::npos) {
+            return std::nullopt;
+        }
+        const std::string_view expected = std::string_view(line).substr(comment + 1);
+        corpus.push_back({ .spec = *spec, .solvable = expected.find("unsolvable") == std::string_view::npos });
+    }
+    return corpus;
+}
+
+static Percentiles percentiles(std::vector<double> values)
+{
+    if (values.empty()) {
+        return {};
+    }
+    std::ranges::sort(values);
+    const auto at = [&](const double fraction) {
+        return values[static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5)];
+    };
+    return { .mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size()),
+             .p50 = at(0.5),
+             .p90 = at(0.9),
+             .p99 = at(0.99),
+             .max = values.back() };
+}
+
+static std::string percentiles_json(const Percentiles& p)
+{
+    return "{\"mean\":" + std::to_string(p.mean) + ",\"p50\":" + std::to_string(p.p50) + ",\"p90\":"
+        + std::to_string(p.p90) + ",\"p99\":" + std::to_string(p.p99) + ",\"max\":" + std::to_string(p.max) + "}";
+}
+
+static FullBoardGame make_game(const BoardSpec& spec)
+{
+    FullBoardGame game(spec.size);
+    game.set_barriers(spec.barriers);
+    return game;
+}
+
+// A game started on its first free cell, with the directions of a seeded random walk from there until stuck
+struct Walk {
+    FullBoardGame game;
+    std::vector<Direction> dirs;
+};
+
+static std::vector<Walk> make_walks(const std::vector<CorpusBoard>& corpus)
+{
+    std::mt19937_64 rng(1);
+    std::vector<Walk> walks;
+    for (const CorpusBoard& board : corpus) {
+        Walk walk { .game = make_game(board.spec), .dirs = {} };
+        const std::optional<Vector2i> start = first_avail_pos(walk.game);
+        if (!start.has_value()) {
+            continue;
+        }
+        walk.game.set_start(*start);
+        FullBoardGame played = walk.game;
+        while (true) {
+            const int first_dir = static_cast<int>(rng() % 4);
+            bool moved = false;
+            for (int i = 0; i < 4 && !moved; ++i) {
+                moved = played.move(idx_dir((first_dir + i) % 4)).record.has_value();
+                if (moved) {
+                    walk.dirs.push_back(idx_dir((first_dir + i) % 4));
+                }
+            }
+            if (!moved) {
+                break;
+            }
+        }
+        if (!walk.dirs.empty()) {
+            walks.push_back(std::move(walk));
+        }
+    }
+    return walks;
+}
+
+// Times `samples` runs of `pass`, which returns the number of operations it did. The first run sets how many passes
+// a sample makes, so each lasts about 10 ms.
+template <typename Pass>
+static void run_micro(const std::string_view name, const int samples, Pass&& pass)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto calibrate_start = Clock::now();
+    pass();
+    const double once = std::chrono::duration<double>(Clock::now() - calibrate_start).count();
+    const int passes = std::max(1, static_cast<int>(0.01 / std::max(once, 1e-9)));
+    std::vector<double> ns_per_op;
+    uint64_t total_ops = 0;
+    for (int s = 0; s < samples; ++s) {
+        uint64_t ops = 0;
+        const auto start = Clock::now();
+        for (int p = 0; p < passes; ++p) {
+            ops += pass();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        ns_per_op.push_back(ns / static_cast<double>(std::max<uint64_t>(ops, 1)));
+        total_ops += ops;
+    }
+    std::cout << "{\"benchmark\":\"" << name << "\",\"samples\":" << samples << ",\"ops\":" << total_ops
+              << ",\"ns_per_op\":" << percentiles_json(percentiles(ns_per_op)) << "}\n";
+}
+
+static void run_micro_benchmarks(const std::vector<CorpusBoard>& corpus, const int samples)
+{
+    std::vector<Walk> walks = make_walks(corpus);
+
+    // A move and its undo are one operation each
+    run_micro("move_undo", samples, [&] {
+        uint64_t ops = 0;
+        for (Walk& walk : walks) {
+            for (const Direction dir : walk.dirs) {
+                walk.game.move(dir);
+            }
+            while (walk.game.undo()) { }
+            ops += 2 * walk.dirs.size();
+        }
+        return ops;
+    });
+
+    std::vector<FullBoardGame::MoveRecord> records;
+    run_micro("slide_unslide", samples, [&] {
+        uint64_t ops = 0;
+        for (Walk& walk : walks) {
+            records.resize(walk.dirs.size());
+            for (size_t i = 0; i < walk.dirs.size(); ++i) {
+                walk.game.slide(walk.dirs[i], records[i]);
+            }
+            for (size_t i = walk.dirs.size(); i-- > 0;) {
+                walk.game.unslide(records[i]);
+            }
+            ops += 2 * walk.dirs.size();
+        }
+        return ops;
+    });
+
+    // Every position along every walk, most of them still open and the last of each one lost
+    std::vector<FullBoardGame> positions;
+    for (const Walk& walk : walks) {
+        FullBoardGame game = walk.game;
+        for (const Direction dir : walk.dirs) {
+            game.move(dir);
+            positions.push_back(game);
+        }
+    }
+    run_micro("check_game_result", samples, [&] {
+        uint64_t results = 0;
+        for (const FullBoardGame& game : positions) {
+            results += game.check_game_result().has_value();
+        }
+        g_sink = results;
+        return positions.size();
+    });
+}
+
+struct SolveRun {
+    bool won;
+    uint64_t nodes;
+};
+
+// Solves every board `repeat` times with `solve`, each time from a fresh game and an empty `table`, and reports the
+// median time of each. Returns the number of boards whose outcome differed from the corpus.
+template <typename Solve>
+static int run_solve_benchmark(
+    const std::string_view name,
+    const std::vector<CorpusBoard>& corpus,
+    const int repeat,
+    TranspositionTable& table,
+    Solve&& solve)
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> board_ms;
+    uint64_t total_nodes = 0;
+    int mismatches = 0;
+    for (size_t b = 0; b < corpus.size(); ++b) {
+        std::vector<double> ms;
+        SolveRun run {};
+        for (int r = 0; r < repeat; ++r) {
+            FullBoardGame game = make_game(corpus[b].spec);
+            table.clear();
+            const auto start = Clock::now();
+            run = solve(game);
+            ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        const double median = percentiles(ms).p50;
+        board_ms.push_back(median);
+        total_nodes += run.nodes;
+        if (run.won != corpus[b].solvable) {
+            mismatches++;
+        }
+        std::cout << "{\"benchmark\":\"" << name << "\",\"board\":" << b << ",\"size\":" << corpus[b].spec.size
+                  << ",\"outcome\":\"" << (run.won ? "solved" : "unsolvable") << "\",\"expected\":\""
+                  << (corpus[b].solvable ? "solved" : "unsolvable") << "\",\"nodes\":" << run.nodes
+                  << ",\"ms\":" << median << "}\n";
+    }
+    const double total_seconds = std::accumulate(board_ms.begin(), board_ms.end(), 0.0) / 1000.0;
+    std::cout << "{\"benchmark\":\"" << name << "\",\"boards\":" << corpus.size() << ",\"repeat\":" << repeat
+              << ",\"nodes\":" << total_nodes << ",\"seconds\":" << total_seconds
+              << ",\"nodes_per_s\":" << static_cast<double>(total_nodes) / std::max(total_seconds, 1e-9)
+              << ",\"mismatches\":" << mismatches << ",\"ms_per_solve\":" << percentiles_json(percentiles(board_ms))
+              << "}\n";
+    return mismatches;
+}
+
+int main(const int argc, char** argv)
+{
+    const std::optional<BenchmarkOptions> options = parse_options(argc, argv);
+    if (!options.has_value()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    const std::optional<std::vector<CorpusBoard>> corpus = load_corpus(options->corpus_path);
+    if (!corpus.has_value()) {
+        std::cerr << "Cannot read the corpus " << options->corpus_path
+                  << ", which needs a board and its expected outcome on every line\n";
+        return EXIT_FAILURE;
+    }
+
+    run_micro_benchmarks(*corpus, options->samples);
+
+    TranspositionTable table(1 << 20);
+    const SolverConfig config { .prune_degrees = true,
+                                .prune_connectivity = true,
+                                .table = &table,
+                                .reduce_symmetry = true,
+                                .constrain_endpoints = true };
+    int mismatches = run_solve_benchmark("solve_step", *corpus, options->repeat, table, [&](FullBoardGame& game) {
+        SolverStats stats;
+        const bool won = auto_solve(game, config, stats);
+        return SolveRun { .won = won, .nodes = stats.nodes };
+    });
+    mismatches += run_solve_benchmark("solve_iterative", *corpus, options->repeat, table, [&](FullBoardGame& game) {
+        IterativeSolver solver(game, config);
+        const bool won = solver.solve();
+        return SolveRun { .won = won, .nodes = solver.stats().nodes };
+    });
+    mismatches += run_solve_benchmark("solve_by_size", *corpus, options->repeat, table, [&](FullBoardGame& game) {
+        SolverStats stats;
+        const bool won = solve_by_size(game, config, stats) == SolveOutcome::solved;
+        return SolveRun { .won = won, .nodes = stats.nodes };
+    });
+    if (mismatches > 0) {
+        std::cerr << mismatches << " solves did not match the expected outcome\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
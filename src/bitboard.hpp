@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// A bit line is a run of 64-bit words holding one bit per cell, least significant bit first.
+
+inline int line_words(const int bit_count)
+{
+    return (bit_count + 63) / 64;
+}
+
+inline bool line_test(const uint64_t* line, const int bit)
+{
+    return (line[bit >> 6] >> (bit & 63)) & 1;
+}
+
+inline void line_set(uint64_t* line, const int bit)
+{
+    line[bit >> 6] |= uint64_t { 1 } << (bit & 63);
+}
+
+inline void line_reset(uint64_t* line, const int bit)
+{
+    line[bit >> 6] &= ~(uint64_t { 1 } << (bit & 63));
+}
+
+// Mask of bits [from, to] of a single word, 0 <= from <= to < 64
+inline uint64_t word_range_mask(const int from, const int to)
+{
+    return (~uint64_t { 0 } >> (63 - to)) & (~uint64_t { 0 } << from);
+}
+
+// Sets bits [from, to] of the line
+inline void line_set_range(uint64_t* line, const int from, const int to)
+{
+    const int first = from >> 6;
+    const int last = to >> 6;
+    if (first == last) {
+        line[first] |= word_range_mask(from & 63, to & 63);
+        return;
+    }
+    line[first] |= ~uint64_t { 0 } << (from & 63);
+    for (int w = first + 1; w < last; ++w) {
+        line[w] = ~uint64_t { 0 };
+    }
+    line[last] |= ~uint64_t { 0 } >> (63 - (to & 63));
+}
+
+// Clears bits [from, to] of the line
+inline void line_reset_range(uint64_t* line, const int from, const int to)
+{
+    const int first = from >> 6;
+    const int last = to >> 6;
+    if (first == last) {
+        line[first] &= ~word_range_mask(from & 63, to & 63);
+        return;
+    }
+    line[first] &= ~(~uint64_t { 0 } << (from & 63));
+    for (int w = first + 1; w < last; ++w) {
+        line[w] = 0;
+    }
+    line[last] &= ~(~uint64_t { 0 } >> (63 - (to & 63)));
+}
+
+// Index of the first set bit in [from, end), or end if there is none
+inline int line_next_set(const uint64_t* line, const int from, const int end)
+{
+    if (from >= end) {
+        return end;
+    }
+    int w = from >> 6;
+    const int last = (end - 1) >> 6;
+    uint64_t word = line[w] & (~uint64_t { 0 } << (from & 63));
+    while (word == 0) {
+        if (++w > last) {
+            return end;
+        }
+        word = line[w];
+    }
+    return std::min(end, w * 64 + std::countr_zero(word));
+}
+
+// Index of the last set bit in [0, from], or -1 if there is none
+inline int line_prev_set(const uint64_t* line, const int from)
+{
+    if (from < 0) {
+        return -1;
+    }
+    int w = from >> 6;
+    uint64_t word = line[w] & (~uint64_t { 0 } >> (63 - (from & 63)));
+    while (word == 0) {
+        if (--w < 0) {
+            return -1;
+        }
+        word = line[w];
+    }
+    return w * 64 + 63 - std::countl_zero(word);
+}
+
+// Adds to `seed` every bit joined to one of its bits by a run of set bits of `open`, in either direction within the
+// word. `seed` must be a subset of `open`. Each doubling stage only passes through spans that are open all the way.
+inline uint64_t word_fill(const uint64_t seed, const uint64_t open)
+{
+    uint64_t up = seed;
+    uint64_t up_open = open;
+    uint64_t down = seed;
+    uint64_t down_open = open;
+    for (int shift = 1; shift < 64; shift *= 2) {
+        up |= up_open & (up << shift);
+        up_open &= up_open << shift;
+        down |= down_open & (down >> shift);
+        down_open &= down_open >> shift;
+    }
+    return up | down;
+}
+
+// Grows word `i` of a flood fill, see flood_fill. Returns whether it changed.
+inline bool flood_fill_word(uint64_t* reached, const uint64_t* open, const int total, const int words, const int i)
+{
+    const int in_line = i % words;
+    uint64_t seed = reached[i];
+    seed |= i >= words ? reached[i - words] : 0;
+    seed |= i + words < total ? reached[i + words] : 0;
+    seed |= in_line > 0 ? reached[i - 1] >> 63 : 0;
+    seed |= in_line < words - 1 ? reached[i + 1] << 63 : 0;
+    seed &= open[i];
+    if (seed == reached[i]) {
+        return false;
+    }
+    reached[i] = word_fill(seed, open[i]);
+    return true;
+}
+
+#if defined(__AVX2__)
+template <int Shift>
+inline void word_fill_stage_x4(__m256i& up, __m256i& up_open, __m256i& down, __m256i& down_open)
+{
+    up = _mm256_or_si256(up, _mm256_and_si256(up_open, _mm256_slli_epi64(up, Shift)));
+    up_open = _mm256_and_si256(up_open, _mm256_slli_epi64(up_open, Shift));
+    down = _mm256_or_si256(down, _mm256_and_si256(down_open, _mm256_srli_epi64(down, Shift)));
+    down_open = _mm256_and_si256(down_open, _mm256_srli_epi64(down_open, Shift));
+}
+
+// word_fill of four words at once
+inline __m256i word_fill_x4(const __m256i seed, const __m256i open)
+{
+    __m256i up = seed;
+    __m256i up_open = open;
+    __m256i down = seed;
+    __m256i down_open = open;
+    word_fill_stage_x4<1>(up, up_open, down, down_open);
+    word_fill_stage_x4<2>(up, up_open, down, down_open);
+    word_fill_stage_x4<4>(up, up_open, down, down_open);
+    word_fill_stage_x4<8>(up, up_open, down, down_open);
+    word_fill_stage_x4<16>(up, up_open, down, down_open);
+    word_fill_stage_x4<32>(up, up_open, down, down_open);
+    return _mm256_or_si256(up, down);
+}
+
+// flood_fill_word of words [i, i + 4), all of which have a line above and below them. The four words can be on
+// neighboring lines, so they are grown again until they stop changing, which carries the fill through them in one
+// call as the scalar sweep would. Returns whether any changed.
+inline bool flood_fill_words_x4(uint64_t* reached, const uint64_t* open, const int words, const int i)
+{
+    const auto load = [](const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); };
+    __m256i first = _mm256_setzero_si256();
+    __m256i last = _mm256_setzero_si256();
+    if (words > 1) {
+        // Carries between the words of a line, but not from the end of one line to the start of the next
+        const auto in_line = [&](const int offset) {
+            return static_cast<long long>((i + offset) % words);
+        };
+        const __m256i positions = _mm256_setr_epi64x(in_line(0), in_line(1), in_line(2), in_line(3));
+        first = _mm256_cmpeq_epi64(positions, _mm256_setzero_si256());
+        last = _mm256_cmpeq_epi64(positions, _mm256_set1_epi64x(static_cast<long long>(words - 1)));
+    }
+    const __m256i open_words = load(open + i);
+    bool changed = false;
+    while (true) {
+        const __m256i current = load(reached + i);
+        __m256i seed = _mm256_or_si256(current, _mm256_or_si256(load(reached + i - words), load(reached + i + words)));
+        if (words > 1) {
+            seed = _mm256_or_si256(seed, _mm256_andnot_si256(first, _mm256_srli_epi64(load(reached + i - 1), 63)));
+            seed = _mm256_or_si256(seed, _mm256_andnot_si256(last, _mm256_slli_epi64(load(reached + i + 1), 63)));
+        }
+        seed = _mm256_and_si256(seed, open_words);
+        if (_mm256_testc_si256(current, seed)) {
+            return changed;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(reached + i), word_fill_x4(seed, open_words));
+        changed = true;
+    }
+}
+#endif
+
+// Grows `reached` through the set bits of `open` until it holds every open cell orthogonally connected to it, by
+// repeated dilation to the neighboring cells and whole runs of open cells along each line. Both are boards of `lines`
+// bit lines of `words` words each, `reached` must start as a subset of `open`, and bits past the end of each line must
+// be clear in `open`. Uses AVX2 when the compiler targets it. Returns the number of reached cells.
+inline int flood_fill(uint64_t* reached, const uint64_t* open, const int lines, const int words)
+{
+    const int total = lines * words;
+    // Words are only refilled along their runs when a neighbor brings in something new, so the seeds start filled
+    for (int i = 0; i < total; ++i) {
+        if (reached[i] != 0) {
+            reached[i] = word_fill(reached[i], open[i]);
+        }
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        // Sweeping down then up carries the fill the length of the board each way per round
+        int i = 0;
+#if defined(__AVX2__)
+        for (; i < words; ++i) {
+            changed |= flood_fill_word(reached, open, total, words, i);
+        }
+        for (; i + 4 + words <= total; i += 4) {
+            changed |= flood_fill_words_x4(reached, open, words, i);
+        }
+#endif
+        for (; i < total; ++i) {
+            changed |= flood_fill_word(reached, open, total, words, i);
+        }
+        i = total - 1;
+#if defined(__AVX2__)
+        for (; i >= total - words; --i) {
+            changed |= flood_fill_word(reached, open, total, words, i);
+        }
+        for (; i - 3 >= words; i -= 4) {
+            changed |= flood_fill_words_x4(reached, open, words, i - 3);
+        }
+#endif
+        for (; i >= 0; --i) {
+            changed |= flood_fill_word(reached, open, total, words, i);
+        }
+    }
+    int count = 0;
+    for (int i = 0; i < total; ++i) {
+        count += std::popcount(reached[i]);
+    }
+    return count;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.hpp"
+#include "full_board_game.hpp"
+
+// Whether all of `text` is a number, which is then stored in `value`
+template <typename T>
+bool parse_number(const std::string_view text, T& value)
+{
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc {} && end == text.data() + text.size();
+}
+
+// Boards are stored one per line as the size followed by the x and y of each barrier, all separated by spaces.
+// Anything after a '#' is a comment, and lines with nothing else on them are skipped. Sizes above
+// FullBoardGame::c_max_size are rejected.
+struct BoardSpec {
+    int size;
+    std::vector<Vector2i> barriers;
+};
+
+inline std::optional<BoardSpec> parse_board_line(std::string_view line)
+{
+    if (const size_t comment = line.find('#'); comment != std::string_view::npos) {
+        line = line.substr(0, comment);
+    }
+    std::vector<int> values;
+    while (true) {
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            break;
+        }
+        line = line.substr(begin);
+        int value;
+        const auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), value);
+        if (error != std::errc {}) {
+            return std::nullopt;
+        }
+        values.push_back(value);
+        line = line.substr(end - line.data());
+    }
+    if (values.empty() || values[0] < 1 || values[0] > FullBoardGame::c_max_size || values.size() % 2 == 0) {
+        return std::nullopt;
+    }
+    BoardSpec spec { .size = values[0], .barriers = {} };
+    for (size_t i = 1; i < values.size(); i += 2) {
+        spec.barriers.push_back({ values[i], values[i + 1] });
+    }
+    return spec;
+}
+
+inline std::string format_board(const int size, const std::span<const Vector2i> barriers)
+{
+    std::string line = std::to_string(size);
+    for (const auto [x, y] : barriers) {
+        line += ' ' + std::to_string(x) + ' ' + std::to_string(y);
+    }
+    return line;
+}
+
+inline char dir_letter(const Direction dir)
+{
+    switch (dir) {
+    case Direction::north:
+        return 'N';
+    case Direction::east:
+        return 'E';
+    case Direction::south:
+        return 'S';
+    case Direction::west:
+        return 'W';
+    default:
+        return '?';
+    }
+}
+
+// The start cell and one letter per move, e.g. "2 3 NESW"
+inline std::string format_solution(const Vector2i start, const FullBoardGame::MoveHistory& moves)
+{
+    std::string text = std::to_string(start.x) + ' ' + std::to_string(start.y) + ' ';
+    for (const FullBoardGame::MoveRecord record : moves) {
+        text += dir_letter(record.dir);
+    }
+    return text;
+}
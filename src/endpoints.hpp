@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "common.hpp"
+#include "full_board_game.hpp"
+
+// Every cell a path passes through is entered from one empty neighbor and left to another, so a cell with a single
+// non-barrier neighbor can only be the first or last cell of a solution, and a cell with none can only be the whole of
+// one. That bounds the start cells before any search.
+struct EndpointAnalysis {
+    // False when the barrier layout has no solution whatever the start
+    bool solvable = true;
+    // Cells with a single non-barrier neighbor. When there are two, the solution starts on one and ends on the other.
+    std::vector<Vector2i> forced;
+};
+
+inline int open_neighbor_count(const FullBoardGame& game, const Vector2i pos)
+{
+    int count = 0;
+    for (std::array<Vector2i, 4> neighbor_offsets { { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } } };
+         const auto [off_x, off_y] : neighbor_offsets) {
+        if (const Vector2i neighbor_pos { pos.x + off_x, pos.y + off_y };
+            game.in_bounds(neighbor_pos) && !game.barrier_at(neighbor_pos)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+inline EndpointAnalysis analyze_endpoints(const FullBoardGame& game)
+{
+    EndpointAnalysis analysis;
+    const int open_cells = game.size() * game.size() - static_cast<int>(game.barrier_positions().size());
+    for (int y = 0; y < game.size(); ++y) {
+        for (int x = 0; x < game.size(); ++x) {
+            if (game.barrier_at({ x, y })) {
+                continue;
+            }
+            if (const int degree = open_neighbor_count(game, { x, y }); degree == 0 && open_cells > 1) {
+                analysis.solvable = false;
+                return analysis;
+            }
+            else if (degree == 1) {
+                analysis.forced.push_back({ x, y });
+                if (analysis.forced.size() > 2) {
+                    analysis.solvable = false;
+                    return analysis;
+                }
+            }
+        }
+    }
+    return analysis;
+}
+
+// Narrows `starts` to the cells the endpoint analysis allows and orders them by their number of non-barrier neighbors,
+// so forced endpoints come first and then the cells most likely to end up as one. Empties it when the layout has no
+// solution.
+inline void constrain_starts(const FullBoardGame& game, std::vector<Vector2i>& starts)
+{
+    const EndpointAnalysis analysis = analyze_endpoints(game);
+    if (!analysis.solvable) {
+        starts.clear();
+        return;
+    }
+    if (analysis.forced.size() == 2) {
+        std::erase_if(starts, [&](const Vector2i pos) {
+            return std::ranges::find(analysis.forced, pos) == analysis.forced.end();
+        });
+    }
+    std::ranges::stable_sort(starts, {}, [&](const Vector2i pos) { return open_neighbor_count(game, pos); });
+}
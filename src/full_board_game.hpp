@@ -1,10 +1,18 @@
 #pragma once
 
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "bitboard.hpp"
 #include "common.hpp"
 
 class FullBoardGame {
-    enum class BoardState { empty, filled };
-
 public:
     enum class Result { won, lost };
 
@@ -19,10 +27,157 @@ public:
         std::optional<Result> game_result {};
     };
 
+    // Largest number of cells a side, which PackedMove can still encode
+    static constexpr int c_max_size = 1023;
+
+    // A move as the history stores it: the index of the cell it started from, its direction and the number of cells it
+    // covered, in 32 bits. That fits boards of up to c_max_size cells a side.
+    class PackedMove {
+    public:
+        PackedMove(const MoveRecord& record, const int board_size)
+            : m_bits(
+                  static_cast<uint32_t>(record.from.y * board_size + record.from.x)
+                  | static_cast<uint32_t>(dir_idx(record.dir)) << c_dir_shift
+                  | static_cast<uint32_t>(std::abs(record.to.x - record.from.x) + std::abs(record.to.y - record.from.y))
+                      << c_length_shift)
+        {
+        }
+
+        [[nodiscard]] MoveRecord unpack(const int board_size) const
+        {
+            const int idx = static_cast<int>(m_bits & c_idx_mask);
+            const Direction dir = idx_dir(static_cast<int>(m_bits >> c_dir_shift) & 3);
+            const int length = static_cast<int>(m_bits >> c_length_shift);
+            const Vector2i from { idx % board_size, idx / board_size };
+            Vector2i to = from;
+            switch (dir) {
+            case Direction::north:
+                to.y -= length;
+                break;
+            case Direction::east:
+                to.x += length;
+                break;
+            case Direction::south:
+                to.y += length;
+                break;
+            case Direction::west:
+                to.x -= length;
+                break;
+            }
+            return { .dir = dir, .from = from, .to = to };
+        }
+
+        bool operator==(const PackedMove&) const = default;
+
+    private:
+        static constexpr uint32_t c_idx_mask = (1u << 20) - 1;
+        static constexpr int c_dir_shift = 20;
+        static constexpr int c_length_shift = 22;
+        static_assert(c_max_size * c_max_size - 1 <= c_idx_mask, "cell indices must fit their bits");
+        static_assert(c_max_size - 1 <= (~uint32_t { 0 } >> c_length_shift), "slide lengths must fit their bits");
+
+        uint32_t m_bits;
+    };
+    static_assert(sizeof(PackedMove) == 4);
+
+    // Read-only view of the history that unpacks each move as it is read
+    class MoveHistory {
+    public:
+        class Iterator {
+        public:
+            using value_type = MoveRecord;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+
+            Iterator(const PackedMove* move, const int board_size)
+                : m_move(move)
+                , m_board_size(board_size)
+            {
+            }
+
+            MoveRecord operator*() const
+            {
+                return m_move->unpack(m_board_size);
+            }
+
+            Iterator& operator++()
+            {
+                ++m_move;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                const Iterator prev = *this;
+                ++m_move;
+                return prev;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return m_move == other.m_move;
+            }
+
+        private:
+            const PackedMove* m_move = nullptr;
+            int m_board_size = 0;
+        };
+
+        MoveHistory(const std::span<const PackedMove> moves, const int board_size)
+            : m_moves(moves)
+            , m_board_size(board_size)
+        {
+        }
+
+        [[nodiscard]] Iterator begin() const
+        {
+            return { m_moves.data(), m_board_size };
+        }
+
+        [[nodiscard]] Iterator end() const
+        {
+            return { m_moves.data() + m_moves.size(), m_board_size };
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return m_moves.size();
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return m_moves.empty();
+        }
+
+        [[nodiscard]] MoveRecord operator[](const size_t i) const
+        {
+            return m_moves[i].unpack(m_board_size);
+        }
+
+        // The moves as stored, for comparing histories without unpacking them
+        [[nodiscard]] std::span<const PackedMove> packed() const
+        {
+            return m_moves;
+        }
+
+    private:
+        std::span<const PackedMove> m_moves;
+        int m_board_size;
+    };
+
     explicit FullBoardGame(const int size)
         : m_size(size)
-        , m_state(m_size * m_size, BoardState::empty)
+        , m_line_words(line_words(size))
+        , m_rows(static_cast<size_t>(m_size) * m_line_words)
+        , m_cols(static_cast<size_t>(m_size) * m_line_words)
     {
+        assert(size >= 1 && size <= c_max_size);
+        clear_board();
+        m_barrier_rows = m_rows;
+        m_barrier_cols = m_cols;
+        m_barrier_degrees = m_degrees;
+        m_barrier_hash = m_hash;
     }
 
     [[nodiscard]] int pos_to_idx(const Vector2i pos) const
@@ -44,7 +199,7 @@ public:
 
     [[nodiscard]] bool filled_at(const Vector2i pos) const
     {
-        return m_state[pos_to_idx(pos)] == BoardState::filled;
+        return line_test(row_line(pos.y), pos.x);
     }
 
     bool undo()
@@ -52,17 +207,8 @@ public:
         if (m_history.empty() || !m_current_pos.has_value()) {
             return false;
         }
-        const auto [dir, from, to] = m_history[m_history.size() - 1];
-        const int min_x = std::min(from.x, to.x);
-        const int max_x = std::max(from.x, to.x);
-        const int min_y = std::min(from.y, to.y);
-        const int max_y = std::max(from.y, to.y);
-        for (int x = min_x; x < max_x + 1; ++x) {
-            for (int y = min_y; y < max_y + 1; ++y) {
-                m_state[pos_to_idx({ x, y })] = BoardState::empty;
-            }
-        }
-        m_state[pos_to_idx(from)] = BoardState::filled;
+        const auto [dir, from, to] = m_history.back().unpack(m_size);
+        set_slide(dir, from, to, false);
         m_current_pos = from;
         m_history.pop_back();
         return true;
@@ -93,7 +239,7 @@ public:
         if (m_history.empty() && !barrier_at(pos)) {
             m_start_pos = pos;
             m_current_pos = pos;
-            m_state[pos_to_idx(pos)] = BoardState::filled;
+            set_cell(pos, true);
         }
     }
 
@@ -102,7 +248,7 @@ public:
         if (m_history.empty()) {
             return {};
         }
-        return m_history.at(m_history.size() - 1);
+        return m_history.back().unpack(m_size);
     }
 
     MoveResult move(const Direction dir)
@@ -112,18 +258,11 @@ public:
         }
         const Vector2i start = *m_current_pos;
         MoveResult result;
-        bool moved = false;
-        const auto inc_y = dir == Direction::north || dir == Direction::south ? dir == Direction::north ? -1 : 1 : 0;
-        const auto inc_x = dir == Direction::east || dir == Direction::west ? dir == Direction::east ? 1 : -1 : 0;
-        while (in_bounds({ m_current_pos->x + inc_x, m_current_pos->y + inc_y })
-               && m_state[pos_to_idx({ m_current_pos->x + inc_x, m_current_pos->y + inc_y })] == BoardState::empty) {
-            m_current_pos = { m_current_pos->x + inc_x, m_current_pos->y + inc_y };
-            m_state[pos_to_idx({ m_current_pos->x, m_current_pos->y })] = BoardState::filled;
-            moved = true;
-        }
-        if (moved) {
+        if (const Vector2i end = slide_end(start, dir); end != start) {
+            set_slide(dir, start, end, true);
+            m_current_pos = end;
             result.record = MoveRecord { .dir = dir, .from = start, .to = *m_current_pos };
-            m_history.push_back(*result.record);
+            m_history.emplace_back(*result.record, m_size);
             m_result.reset();
             m_result = check_game_result();
             result.game_result = m_result;
@@ -131,25 +270,76 @@ public:
         return result;
     }
 
+    // Slides like move, but without recording the move in the history or checking the result, for solvers that keep
+    // their own move stack. Returns whether anything moved, with the move in `record`.
+    bool slide(const Direction dir, MoveRecord& record)
+    {
+        if (!m_current_pos.has_value()) {
+            return false;
+        }
+        const Vector2i start = *m_current_pos;
+        const Vector2i end = slide_end(start, dir);
+        if (end == start) {
+            return false;
+        }
+        set_slide(dir, start, end, true);
+        m_current_pos = end;
+        m_result.reset();
+        record = MoveRecord { .dir = dir, .from = start, .to = end };
+        return true;
+    }
+
+    // Takes back the latest slide, given its record
+    void unslide(const MoveRecord& record)
+    {
+        set_slide(record.dir, record.from, record.to, false);
+        m_current_pos = record.from;
+        m_result.reset();
+    }
+
     void set_barrier(const Vector2i pos, const bool value)
     {
-        const int idx = pos_to_idx(pos);
         if (value) {
-            if (std::ranges::find(m_barriers, pos) == m_barriers.end() && m_state[idx] == BoardState::empty) {
+            if (!barrier_at(pos) && !filled_at(pos)) {
                 m_barriers.push_back(pos);
-                m_state[pos_to_idx(pos)] = BoardState::filled;
+                set_barrier_cell(pos, true);
+                set_cell(pos, true);
             }
         }
-        else if (std::ranges::find(m_barriers, pos) != m_barriers.end()) {
-            m_state[pos_to_idx(pos)] = BoardState::empty;
+        else if (barrier_at(pos)) {
+            set_cell(pos, false);
+            set_barrier_cell(pos, false);
             std::erase(m_barriers, pos);
         }
         m_result = check_game_result();
     }
 
+    // Replaces the whole barrier layer and restarts the game on it. Out of bounds and repeated positions are ignored.
+    void set_barriers(const std::span<const Vector2i> positions)
+    {
+        clear_board();
+        m_barriers.clear();
+        for (const Vector2i pos : positions) {
+            if (in_bounds(pos) && !filled_at(pos)) {
+                m_barriers.push_back(pos);
+                set_cell(pos, true);
+            }
+        }
+        m_barrier_rows = m_rows;
+        m_barrier_cols = m_cols;
+        m_barrier_degrees = m_degrees;
+        m_barrier_hash = m_hash;
+        reset_leave_barriers();
+    }
+
+    void clear_barriers()
+    {
+        set_barriers({});
+    }
+
     [[nodiscard]] bool barrier_at(const Vector2i pos) const
     {
-        return std::ranges::find(m_barriers, pos) != m_barriers.end();
+        return line_test(m_barrier_rows.data() + static_cast<size_t>(pos.y) * m_line_words, pos.x);
     }
 
     void toggle_barrier(const Vector2i pos)
@@ -163,9 +353,12 @@ public:
         m_current_pos.reset();
         m_history.clear();
         m_result.reset();
-        m_state.clear();
-        m_state.resize(m_size * m_size, BoardState::empty);
+        clear_board();
         m_barriers.clear();
+        m_barrier_rows = m_rows;
+        m_barrier_cols = m_cols;
+        m_barrier_degrees = m_degrees;
+        m_barrier_hash = m_hash;
     }
 
     void reset_leave_barriers()
@@ -174,11 +367,11 @@ public:
         m_current_pos.reset();
         m_history.clear();
         m_result.reset();
-        m_state.clear();
-        m_state.resize(m_size * m_size, BoardState::empty);
-        for (auto [x, y] : m_barriers) {
-            m_state[pos_to_idx({ x, y })] = BoardState::filled;
-        }
+        m_rows = m_barrier_rows;
+        m_cols = m_barrier_cols;
+        m_degrees = m_barrier_degrees;
+        m_hash = m_barrier_hash;
+        m_empty_count = m_size * m_size - static_cast<int>(m_barriers.size());
     }
 
     [[nodiscard]] int size() const
@@ -186,9 +379,9 @@ public:
         return m_size;
     }
 
-    [[nodiscard]] const std::vector<MoveRecord>& move_history() const
+    [[nodiscard]] MoveHistory move_history() const
     {
-        return m_history;
+        return { m_history, m_size };
     }
 
     [[nodiscard]] const std::vector<Vector2i>& barrier_positions() const
@@ -196,24 +389,152 @@ public:
         return m_barriers;
     }
 
-    [[nodiscard]] std::optional<Result> check_game_result() const
+    // The filled cells as one bit line per row, which together with the current position identifies a position exactly
+    [[nodiscard]] std::span<const uint64_t> filled_rows() const
     {
-        bool full = true;
-        for (int i = 0; i < m_size * m_size; ++i) {
-            if (m_state[i] == BoardState::empty) {
-                full = false;
-                break;
+        return m_rows;
+    }
+
+    [[nodiscard]] int empty_count() const
+    {
+        return m_empty_count;
+    }
+
+    // Whether every empty cell can be reached from the current position through orthogonally adjacent empty cells
+    [[nodiscard]] bool empty_cells_connected() const
+    {
+        if (!m_current_pos.has_value() || m_empty_count == 0) {
+            return true;
+        }
+        // The current cell is filled, so it is opened up as the seed of the fill and left out of the count
+        reserve_scratch();
+        const size_t current_line = static_cast<size_t>(m_current_pos->y) * m_line_words;
+        for (size_t i = 0; i < m_rows.size(); ++i) {
+            m_flood_open[i] = ~m_rows[i];
+            m_flood_reached[i] = 0;
+        }
+        line_set(m_flood_open.data() + current_line, m_current_pos->x);
+        line_set(m_flood_reached.data() + current_line, m_current_pos->x);
+        return flood_fill(m_flood_reached.data(), m_flood_open.data(), m_size, m_line_words) - 1 == m_empty_count;
+    }
+
+    // Sizes the scratch space of empty_cells_connected for the whole board, so later calls never allocate
+    void reserve_scratch() const
+    {
+        m_flood_open.resize(m_rows.size());
+        m_flood_reached.resize(m_rows.size());
+    }
+
+    // Keeps running totals of the empty cells with zero and one empty neighbors through every change to the board, for
+    // empty_degrees_feasible. It costs a few word operations per move and undo, so it is off until a solver asks.
+    void track_degrees(const bool enabled)
+    {
+        if (enabled && !m_track_degrees) {
+            m_degrees = DegreeCounts {};
+            count_degrees(m_degrees, m_rows, 0, m_size - 1, 0, m_size - 1, 1);
+            m_barrier_degrees = DegreeCounts {};
+            count_degrees(m_barrier_degrees, m_barrier_rows, 0, m_size - 1, 0, m_size - 1, 1);
+        }
+        m_track_degrees = enabled;
+    }
+
+    [[nodiscard]] bool tracking_degrees() const
+    {
+        return m_track_degrees;
+    }
+
+    // Whether the empty neighbor counts still allow a single path from the current position through every empty cell.
+    // Only the last cell of that path can be entered without also being left, so it fails when an empty cell has no
+    // way in at all, or when two of them have only one. The current position is a way into the cells next to it.
+    [[nodiscard]] bool empty_degrees_feasible() const
+    {
+        if (!m_current_pos.has_value()) {
+            return true;
+        }
+        int isolated = m_degrees.isolated;
+        int dead_ends = m_degrees.dead_ends;
+        for (std::array<Vector2i, 4> neighbor_offsets { { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } } };
+             const auto [off_x, off_y] : neighbor_offsets) {
+            if (const Vector2i neighbor_pos { m_current_pos->x + off_x, m_current_pos->y + off_y };
+                in_bounds(neighbor_pos) && !filled_at(neighbor_pos)) {
+                if (const int degree = empty_neighbor_count(neighbor_pos); degree == 0) {
+                    isolated--;
+                    dead_ends++;
+                }
+                else if (degree == 1) {
+                    dead_ends--;
+                }
             }
         }
-        if (full) {
+        return isolated == 0 && dead_ends <= 1;
+    }
+
+    [[nodiscard]] int empty_neighbor_count(const Vector2i pos) const
+    {
+        int count = 0;
+        for (std::array<Vector2i, 4> neighbor_offsets { { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } } };
+             const auto [off_x, off_y] : neighbor_offsets) {
+            if (const Vector2i neighbor_pos { pos.x + off_x, pos.y + off_y };
+                in_bounds(neighbor_pos) && !filled_at(neighbor_pos)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Keeps a Zobrist hash of the position up to date through every change to the board, for hash(). Like
+    // track_degrees it costs some work per slid cell, so it is off until a solver asks.
+    void track_hash(const bool enabled)
+    {
+        if (enabled && !m_track_hash) {
+            m_hash = hash_cells(m_rows);
+            m_barrier_hash = hash_cells(m_barrier_rows);
+        }
+        m_track_hash = enabled;
+    }
+
+    [[nodiscard]] bool tracking_hash() const
+    {
+        return m_track_hash;
+    }
+
+    // Zobrist hash of the board size, the filled cells and the current position, which is all that decides how a game
+    // can continue. Cell keys come from flat indices, which boards of different sizes share, so the size is folded in
+    // to keep their positions apart in a table they share.
+    [[nodiscard]] uint64_t hash() const
+    {
+        const uint64_t hash = m_hash ^ size_key(m_size);
+        return m_current_pos.has_value() ? hash ^ cell_key(-1 - pos_to_idx(*m_current_pos)) : hash;
+    }
+
+    // Zobrist key of a cell index, drawn from a fixed splitmix64 sequence so that copies of a board hash alike across
+    // threads. Negative indices key the current position. Public, with size_key, for solvers that keep their own
+    // board but share a table with this one.
+    static uint64_t cell_key(const int idx)
+    {
+        return mix_key(static_cast<uint64_t>(idx) * 0x9e3779b97f4a7c15 + 0x9e3779b97f4a7c15);
+    }
+
+    // Key of the board size, from a sequence apart from the cell keys
+    static uint64_t size_key(const int size)
+    {
+        return mix_key(static_cast<uint64_t>(size) * 0xd1b54a32d192ed03 + 0x8cb92ba72f3d8dd7);
+    }
+
+    [[nodiscard]] std::optional<Result> check_game_result() const
+    {
+        if (m_empty_count == 0) {
             return Result::won;
         }
+        if (!m_current_pos.has_value()) {
+            return std::nullopt;
+        }
 
         bool trapped = true;
         for (std::array<Vector2i, 4> neighbor_offsets { { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } } };
              const auto [off_x, off_y] : neighbor_offsets) {
             if (const Vector2i neighbor_pos { m_current_pos->x + off_x, m_current_pos->y + off_y };
-                in_bounds(neighbor_pos) && m_state[pos_to_idx(neighbor_pos)] == BoardState::empty) {
+                in_bounds(neighbor_pos) && !filled_at(neighbor_pos)) {
                 trapped = false;
                 break;
             }
@@ -225,11 +546,251 @@ public:
     }
 
 private:
+    // Empty cells that have no empty orthogonal neighbor, and those that have exactly one
+    struct DegreeCounts {
+        int isolated = 0;
+        int dead_ends = 0;
+    };
+
+    // The splitmix64 finalizer
+    static uint64_t mix_key(uint64_t key)
+    {
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111eb;
+        return key ^ (key >> 31);
+    }
+
+    [[nodiscard]] uint64_t hash_cells(const std::vector<uint64_t>& rows) const
+    {
+        uint64_t hash = 0;
+        for (int y = 0; y < m_size; ++y) {
+            for (int x = 0; x < m_size; ++x) {
+                if (line_test(rows.data() + static_cast<size_t>(y) * m_line_words, x)) {
+                    hash ^= cell_key(pos_to_idx({ x, y }));
+                }
+            }
+        }
+        return hash;
+    }
+
+    [[nodiscard]] const uint64_t* row_line(const int y) const
+    {
+        return m_rows.data() + static_cast<size_t>(y) * m_line_words;
+    }
+
+    [[nodiscard]] uint64_t* row_line(const int y)
+    {
+        return m_rows.data() + static_cast<size_t>(y) * m_line_words;
+    }
+
+    [[nodiscard]] const uint64_t* col_line(const int x) const
+    {
+        return m_cols.data() + static_cast<size_t>(x) * m_line_words;
+    }
+
+    [[nodiscard]] uint64_t* col_line(const int x)
+    {
+        return m_cols.data() + static_cast<size_t>(x) * m_line_words;
+    }
+
+    // Cell a slide from `from` stops on, which is `from` itself when the neighbor in that direction is blocked
+    [[nodiscard]] Vector2i slide_end(const Vector2i from, const Direction dir) const
+    {
+        switch (dir) {
+        case Direction::north:
+            return { from.x, line_prev_set(col_line(from.x), from.y - 1) + 1 };
+        case Direction::east:
+            return { line_next_set(row_line(from.y), from.x + 1, m_size) - 1, from.y };
+        case Direction::south:
+            return { from.x, line_next_set(col_line(from.x), from.y + 1, m_size) - 1 };
+        case Direction::west:
+            return { line_prev_set(row_line(from.y), from.x - 1) + 1, from.y };
+        default:
+            return from;
+        }
+    }
+
+    // Fills or empties the cells a slide covers, excluding the cell it started from
+    void set_slide(const Direction dir, const Vector2i from, const Vector2i to, const bool filled)
+    {
+        const int length = std::abs(to.x - from.x) + std::abs(to.y - from.y);
+        m_empty_count += filled ? -length : length;
+        if (dir == Direction::east || dir == Direction::west) {
+            const int min_x = dir == Direction::east ? from.x + 1 : to.x;
+            const int max_x = dir == Direction::east ? to.x : from.x - 1;
+            if (m_track_degrees) {
+                count_degrees(m_degrees, m_rows, from.y - 1, from.y + 1, min_x - 1, max_x + 1, -1);
+            }
+            if (filled) {
+                line_set_range(row_line(from.y), min_x, max_x);
+                for (int x = min_x; x <= max_x; ++x) {
+                    line_set(col_line(x), from.y);
+                }
+            }
+            else {
+                line_reset_range(row_line(from.y), min_x, max_x);
+                for (int x = min_x; x <= max_x; ++x) {
+                    line_reset(col_line(x), from.y);
+                }
+            }
+            if (m_track_degrees) {
+                count_degrees(m_degrees, m_rows, from.y - 1, from.y + 1, min_x - 1, max_x + 1, 1);
+            }
+            if (m_track_hash) {
+                for (int x = min_x; x <= max_x; ++x) {
+                    m_hash ^= cell_key(pos_to_idx({ x, from.y }));
+                }
+            }
+        }
+        else {
+            const int min_y = dir == Direction::south ? from.y + 1 : to.y;
+            const int max_y = dir == Direction::south ? to.y : from.y - 1;
+            if (m_track_degrees) {
+                count_degrees(m_degrees, m_cols, from.x - 1, from.x + 1, min_y - 1, max_y + 1, -1);
+            }
+            if (filled) {
+                line_set_range(col_line(from.x), min_y, max_y);
+                for (int y = min_y; y <= max_y; ++y) {
+                    line_set(row_line(y), from.x);
+                }
+            }
+            else {
+                line_reset_range(col_line(from.x), min_y, max_y);
+                for (int y = min_y; y <= max_y; ++y) {
+                    line_reset(row_line(y), from.x);
+                }
+            }
+            if (m_track_degrees) {
+                count_degrees(m_degrees, m_cols, from.x - 1, from.x + 1, min_y - 1, max_y + 1, 1);
+            }
+            if (m_track_hash) {
+                for (int y = min_y; y <= max_y; ++y) {
+                    m_hash ^= cell_key(pos_to_idx({ from.x, y }));
+                }
+            }
+        }
+    }
+
+    // Adds `sign` times the number of isolated and dead end cells among bits [from, to] of lines [first, last] of
+    // `lines`. Neighbor counts are the same either way round, so `lines` can be a row-major or a column-major board.
+    void count_degrees(
+        DegreeCounts& counts,
+        const std::vector<uint64_t>& lines,
+        const int first,
+        const int last,
+        const int from,
+        const int to,
+        const int sign) const
+    {
+        const int bit_from = std::max(from, 0);
+        const int bit_to = std::min(to, m_size - 1);
+        for (int i = std::max(first, 0); i <= std::min(last, m_size - 1); ++i) {
+            const uint64_t* line = lines.data() + static_cast<size_t>(i) * m_line_words;
+            for (int w = bit_from >> 6; w <= bit_to >> 6; ++w) {
+                const uint64_t empty = ~line[w];
+                const uint64_t before = (empty << 1) | (w > 0 ? ~line[w - 1] >> 63 : 0);
+                const uint64_t after = (empty >> 1) | (w < m_line_words - 1 ? ~line[w + 1] << 63 : 0);
+                const uint64_t prev_line = i > 0 ? ~line[w - m_line_words] : 0;
+                const uint64_t next_line = i < m_size - 1 ? ~line[w + m_line_words] : 0;
+                const uint64_t cells
+                    = empty & word_range_mask(std::max(bit_from - w * 64, 0), std::min(bit_to - w * 64, 63));
+                counts.isolated += sign * std::popcount(cells & ~(before | after | prev_line | next_line));
+                counts.dead_ends += sign
+                    * std::popcount(cells & (before ^ after ^ prev_line ^ next_line)
+                                    & ~((before & after) | (prev_line & next_line)));
+            }
+        }
+    }
+
+    void set_cell(const Vector2i pos, const bool filled)
+    {
+        if (filled_at(pos) == filled) {
+            return;
+        }
+        m_empty_count += filled ? -1 : 1;
+        if (m_track_hash) {
+            m_hash ^= cell_key(pos_to_idx(pos));
+        }
+        if (m_track_degrees) {
+            count_degrees(m_degrees, m_rows, pos.y - 1, pos.y + 1, pos.x - 1, pos.x + 1, -1);
+        }
+        if (filled) {
+            line_set(row_line(pos.y), pos.x);
+            line_set(col_line(pos.x), pos.y);
+        }
+        else {
+            line_reset(row_line(pos.y), pos.x);
+            line_reset(col_line(pos.x), pos.y);
+        }
+        if (m_track_degrees) {
+            count_degrees(m_degrees, m_rows, pos.y - 1, pos.y + 1, pos.x - 1, pos.x + 1, 1);
+        }
+    }
+
+    void set_barrier_cell(const Vector2i pos, const bool barrier)
+    {
+        uint64_t* row = m_barrier_rows.data() + static_cast<size_t>(pos.y) * m_line_words;
+        uint64_t* col = m_barrier_cols.data() + static_cast<size_t>(pos.x) * m_line_words;
+        if (m_track_hash) {
+            m_barrier_hash ^= cell_key(pos_to_idx(pos));
+        }
+        if (m_track_degrees) {
+            count_degrees(m_barrier_degrees, m_barrier_rows, pos.y - 1, pos.y + 1, pos.x - 1, pos.x + 1, -1);
+        }
+        if (barrier) {
+            line_set(row, pos.x);
+            line_set(col, pos.y);
+        }
+        else {
+            line_reset(row, pos.x);
+            line_reset(col, pos.y);
+        }
+        if (m_track_degrees) {
+            count_degrees(m_barrier_degrees, m_barrier_rows, pos.y - 1, pos.y + 1, pos.x - 1, pos.x + 1, 1);
+        }
+    }
+
+    // Empties every cell, keeping the padding bits past the end of each line set so they read as filled
+    void clear_board()
+    {
+        std::ranges::fill(m_rows, 0);
+        std::ranges::fill(m_cols, 0);
+        m_empty_count = m_size * m_size;
+        m_hash = 0;
+        if (const int line_bits = m_line_words * 64; m_size < line_bits) {
+            for (int i = 0; i < m_size; ++i) {
+                line_set_range(row_line(i), m_size, line_bits - 1);
+                line_set_range(col_line(i), m_size, line_bits - 1);
+            }
+        }
+        m_degrees = DegreeCounts {};
+        if (m_track_degrees) {
+            count_degrees(m_degrees, m_rows, 0, m_size - 1, 0, m_size - 1, 1);
+        }
+    }
+
     int m_size;
+    int m_line_words;
     std::optional<Vector2i> m_start_pos;
     std::optional<Vector2i> m_current_pos;
-    std::vector<MoveRecord> m_history;
-    std::vector<BoardState> m_state;
+    std::vector<PackedMove> m_history;
+    // Filled cells (barriers included) as one bit line per row, and the same bits transposed into one line per column
+    std::vector<uint64_t> m_rows;
+    std::vector<uint64_t> m_cols;
+    int m_empty_count;
+    bool m_track_degrees = false;
+    DegreeCounts m_degrees;
+    bool m_track_hash = false;
+    // Zobrist hash of the filled cells alone
+    uint64_t m_hash;
     std::vector<Vector2i> m_barriers;
+    // Barrier cells in the same layout as m_rows and m_cols, so a restart is a plain copy
+    std::vector<uint64_t> m_barrier_rows;
+    std::vector<uint64_t> m_barrier_cols;
+    DegreeCounts m_barrier_degrees;
+    uint64_t m_barrier_hash;
     std::optional<Result> m_result;
+    // Scratch space for empty_cells_connected
+    mutable std::vector<uint64_t> m_flood_open;
+    mutable std::vector<uint64_t> m_flood_reached;
 };
\ No newline at end of file
@@ -1,6 +1,186 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "endpoints.hpp"
 #include "full_board_game.hpp"
+#include "symmetry.hpp"
+#include "transposition_table.hpp"
+
+struct SolverConfig {
+    // Abandons a move when the empty neighbor counts leave a cell that cannot be entered, or more than one dead end
+    bool prune_degrees = false;
+    // Abandons a move as soon as some empty cell can no longer be reached from the current position
+    bool prune_connectivity = false;
+    // Abandons positions already proven dead, and records every position found to be dead. Positions don't depend on
+    // the start cell, so one table serves every start of a board and can be shared between threads.
+    TranspositionTable* table = nullptr;
+    // Only tries the first start cell of each set of cells the barrier layout's rotations and reflections swap around
+    bool reduce_symmetry = false;
+    // Only tries the start cells the forced endpoint analysis allows, most constrained first, and gives up at once on
+    // layouts it proves unsolvable
+    bool constrain_endpoints = false;
+};
+
+// Filled in by the solvers as they go, with plain counters so the search stays fast. Solvers add to what is already
+// there, so one instance can follow a solve across several calls.
+struct SolverStats {
+    // Moves made, including those taken back at once by pruning
+    uint64_t nodes = 0;
+    // Moves taken back, whether pruned or backtracked over
+    uint64_t undos = 0;
+    uint64_t starts_tried = 0;
+    // Most moves on the path at once
+    int max_depth = 0;
+    uint64_t pruned_degrees = 0;
+    // Table probes that found the position, each of which pruned it
+    uint64_t pruned_table = 0;
+    uint64_t pruned_connectivity = 0;
+    // Table probes that did not find the position
+    uint64_t table_misses = 0;
+    uint64_t table_stores = 0;
+    // Stores that pushed another position out of its slot
+    uint64_t table_evictions = 0;
+    // Wall time spent in the solver calls
+    std::chrono::nanoseconds elapsed { 0 };
+
+    SolverStats& operator+=(const SolverStats& other)
+    {
+        nodes += other.nodes;
+        undos += other.undos;
+        starts_tried += other.starts_tried;
+        max_depth = std::max(max_depth, other.max_depth);
+        pruned_degrees += other.pruned_degrees;
+        pruned_table += other.pruned_table;
+        pruned_connectivity += other.pruned_connectivity;
+        table_misses += other.table_misses;
+        table_stores += other.table_stores;
+        table_evictions += other.table_evictions;
+        elapsed += other.elapsed;
+        return *this;
+    }
+
+    [[nodiscard]] double nodes_per_second() const
+    {
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0;
+    }
+};
+
+// Adds the time from its construction to its destruction to the elapsed time of `stats`
+class SolveTimer {
+public:
+    explicit SolveTimer(SolverStats& stats)
+        : m_stats(stats)
+        , m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    SolveTimer(const SolveTimer&) = delete;
+    SolveTimer& operator=(const SolveTimer&) = delete;
+
+    ~SolveTimer()
+    {
+        m_stats.elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start);
+    }
+
+private:
+    SolverStats& m_stats;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// When a solve gives up before it is finished, and how it reports on the way. Every limit is optional.
+struct SolveLimits {
+    // Stops the solve once another thread raises it
+    const std::atomic<bool>* stop = nullptr;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    // Nodes the solve may make, counted from where the stats stood when it was called
+    std::optional<uint64_t> node_budget;
+    // Called with the stats so far, their elapsed time included, about once every progress_interval. It runs on the
+    // solving thread between moves, so it may look at the game being solved.
+    std::function<void(const SolverStats&)> on_progress;
+    std::chrono::steady_clock::duration progress_interval = std::chrono::milliseconds(100);
+};
+
+// Applies SolveLimits to a running solve. The stop flag is a relaxed load on every call, so a raised flag is seen
+// within one move, while the node budget, deadline and progress callback are only looked at once every c_check_nodes
+// nodes, which keeps clock reads off the search itself. The limits must outlive it.
+class SolveControl {
+public:
+    SolveControl() = default;
+
+    SolveControl(const SolveLimits& limits, const SolverStats& stats)
+        : m_limits(&limits)
+        , m_budget_end(
+              limits.node_budget.has_value() ? stats.nodes + *limits.node_budget
+                                             : std::numeric_limits<uint64_t>::max())
+        , m_next_check(stats.nodes)
+        , m_start(std::chrono::steady_clock::now())
+        , m_start_elapsed(stats.elapsed)
+        , m_next_progress(m_start + limits.progress_interval)
+    {
+    }
+
+    // Whether the solve should return now. Once it has said so it keeps saying so.
+    bool should_stop(const SolverStats& stats)
+    {
+        if (m_stopped || m_limits == nullptr) {
+            return m_stopped;
+        }
+        if (m_limits->stop != nullptr && m_limits->stop->load(std::memory_order_relaxed)) {
+            m_stopped = true;
+            return true;
+        }
+        if (stats.nodes < m_next_check) {
+            return false;
+        }
+        m_next_check = std::min(stats.nodes + c_check_nodes, m_budget_end);
+        if (stats.nodes >= m_budget_end) {
+            m_stopped = true;
+            return true;
+        }
+        if (!m_limits->deadline.has_value() && !m_limits->on_progress) {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (m_limits->deadline.has_value() && now >= *m_limits->deadline) {
+            m_stopped = true;
+            return true;
+        }
+        if (m_limits->on_progress && now >= m_next_progress) {
+            // The solver's SolveTimer only adds the time of the call once it returns
+            SolverStats progress = stats;
+            progress.elapsed = m_start_elapsed + std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_start);
+            m_limits->on_progress(progress);
+            m_next_progress = now + m_limits->progress_interval;
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool stopped() const
+    {
+        return m_stopped;
+    }
+
+private:
+    static constexpr uint64_t c_check_nodes = 16;
+
+    const SolveLimits* m_limits = nullptr;
+    uint64_t m_budget_end = std::numeric_limits<uint64_t>::max();
+    uint64_t m_next_check = 0;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::nanoseconds m_start_elapsed { 0 };
+    std::chrono::steady_clock::time_point m_next_progress;
+    bool m_stopped = false;
+};
 
 inline std::optional<Vector2i> next_pos(const FullBoardGame& game, const Vector2i prev)
 {
@@ -14,27 +194,79 @@ inline std::optional<Vector2i> next_pos(const FullBoardGame& game, const Vector2
     return std::nullopt;
 };
 
-inline void solve_step_local(FullBoardGame& game)
+// Records in `table` that the position with `hash` and `empty_cells` empty cells has no solution
+inline void store_dead(TranspositionTable& table, const uint64_t hash, const int empty_cells, SolverStats& stats)
 {
+    const StoreResult result = table.store(hash, empty_cells);
+    stats.table_stores += result != StoreResult::rejected;
+    stats.table_evictions += result == StoreResult::evicted;
+}
+
+// Whether the position reached by the last move can be abandoned without searching it
+inline bool should_prune(const FullBoardGame& game, const SolverConfig& config, SolverStats& stats)
+{
+    if (config.prune_degrees && game.tracking_degrees() && !game.won() && !game.empty_degrees_feasible()) {
+        stats.pruned_degrees++;
+        return true;
+    }
+    if (config.table != nullptr && !game.won()) {
+        if (config.table->probe(game.hash())) {
+            stats.pruned_table++;
+            return true;
+        }
+        stats.table_misses++;
+    }
+    if (config.prune_connectivity && !game.won() && !game.empty_cells_connected()) {
+        stats.pruned_connectivity++;
+        return true;
+    }
+    return false;
+}
+
+inline void solve_step_local(FullBoardGame& game, const SolverConfig& config, SolverStats& stats)
+{
+    if (config.prune_degrees) {
+        game.track_degrees(true);
+    }
+    if (config.table != nullptr) {
+        game.track_hash(true);
+    }
     auto start = Direction::north;
     while (true) {
         for (int i = dir_idx(start); i < 4; ++i) {
             if (game.move(idx_dir(i)).record.has_value()) {
-                return;
+                stats.nodes++;
+                stats.max_depth = std::max(stats.max_depth, static_cast<int>(game.move_history().size()));
+                if (!should_prune(game, config, stats)) {
+                    return;
+                }
+                game.undo();
+                stats.undos++;
             }
         }
         std::optional<Direction> next;
         do {
-            const Direction last = game.last_move()->dir;
-            if (!game.undo()) {
+            // Every direction from here has failed
+            if (config.table != nullptr) {
+                store_dead(*config.table, game.hash(), game.empty_count(), stats);
+            }
+            const std::optional<FullBoardGame::MoveRecord> last = game.last_move();
+            if (!last.has_value() || !game.undo()) {
                 return;
             }
-            next = next_dir(last);
+            stats.undos++;
+            next = next_dir(last->dir);
         } while (!next.has_value());
         start = *next;
     }
 }
 
+inline void solve_step_local(FullBoardGame& game)
+{
+    SolverStats stats;
+    solve_step_local(game, SolverConfig {}, stats);
+}
+
 inline std::optional<Vector2i> first_avail_pos(const FullBoardGame& game)
 {
     if (const std::optional<Vector2i> next = next_pos(game, game.idx_to_pos(-1)); next.has_value()) {
@@ -43,38 +275,159 @@ inline std::optional<Vector2i> first_avail_pos(const FullBoardGame& game)
     return std::nullopt;
 }
 
+// Every cell `config` asks a solution to be tried from, in the order auto_solve_update tries them
+inline std::vector<Vector2i> start_candidates(const FullBoardGame& game, const SolverConfig& config = {})
+{
+    const std::vector<int> symmetries = config.reduce_symmetry ? layout_symmetries(game) : std::vector<int> { 0 };
+    std::vector<Vector2i> starts;
+    for (std::optional<Vector2i> pos = first_avail_pos(game); pos.has_value(); pos = next_pos(game, *pos)) {
+        if (is_orbit_representative(game, symmetries, *pos)) {
+            starts.push_back(*pos);
+        }
+    }
+    if (config.constrain_endpoints) {
+        constrain_starts(game, starts);
+    }
+    return starts;
+}
+
+// Start cell to try after `prev`, or the first one when there is no `prev`. A `prev` that is not a candidate, such as
+// one picked by hand, is followed by the first candidate.
+inline std::optional<Vector2i> next_start(
+    const FullBoardGame& game, const SolverConfig& config, const std::optional<Vector2i> prev)
+{
+    if (!config.reduce_symmetry && !config.constrain_endpoints) {
+        return prev.has_value() ? next_pos(game, *prev) : first_avail_pos(game);
+    }
+    const std::vector<Vector2i> starts = start_candidates(game, config);
+    auto it = prev.has_value() ? std::ranges::find(starts, *prev) : starts.end();
+    it = it == starts.end() ? starts.begin() : std::next(it);
+    if (it == starts.end()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+// Restarts the game from `start` and searches until it is won, every line from the start has failed, or `limits` stop
+// it. Returns whether it was won.
+inline bool solve_from_start(
+    FullBoardGame& game,
+    const Vector2i start,
+    const SolverConfig& config,
+    SolverStats& stats,
+    const SolveLimits& limits)
+{
+    const SolveTimer timer(stats);
+    SolveControl control(limits, stats);
+    game.reset_leave_barriers();
+    game.set_start(start);
+    stats.starts_tried++;
+    do {
+        solve_step_local(game, config, stats);
+    } while (!game.won() && !game.move_history().empty() && !control.should_stop(stats));
+    return game.won();
+}
+
+// Restarts `game` from `start` and makes the direction `dir_of` gives for each of `moves`, which leaves a solution as a
+// winning auto_solve_update would. With no start the game is only cleared.
+template <typename Moves, typename DirOf = std::identity>
+void replay_solution(FullBoardGame& game, const std::optional<Vector2i> start, const Moves& moves, DirOf dir_of = {})
+{
+    game.reset_leave_barriers();
+    if (!start.has_value()) {
+        return;
+    }
+    game.set_start(*start);
+    for (const auto& move : moves) {
+        game.move(std::invoke(dir_of, move));
+    }
+}
+
 enum class AutoSolveResult { should_continue, should_stop };
 
+// How a whole solve ended, for the solvers that run one in a single call
+enum class SolveOutcome { solved, unsolvable, stopped };
+
+// Gives `game` the first start cell to try when it has no start yet. Returns false when there is none.
+inline bool set_first_start(FullBoardGame& game, const SolverConfig& config, SolverStats& stats)
+{
+    if (game.start_pos().has_value()) {
+        return true;
+    }
+    const std::optional<Vector2i> pos = next_start(game, config, std::nullopt);
+    if (!pos.has_value()) {
+        return false;
+    }
+    game.set_start(pos.value());
+    stats.starts_tried++;
+    return true;
+}
+
+// One solve_step_local, moving on to the next start cell once every line from the current one has failed. Returns
+// false when that was the last start.
+inline bool auto_solve_step(FullBoardGame& game, const SolverConfig& config, SolverStats& stats)
+{
+    solve_step_local(game, config, stats);
+    if (!game.move_history().empty()) {
+        return true;
+    }
+    const std::optional<Vector2i> next = next_start(game, config, game.start_pos());
+    game.reset_leave_barriers();
+    if (!next.has_value()) {
+        return false;
+    }
+    game.set_start(next.value());
+    stats.starts_tried++;
+    return true;
+}
+
+// Carries the solve on from where `game` stands, trying the next start cell each time one fails, until it is won, every
+// start has failed, or `limits` stop it. Returns should_stop in the first two cases.
 inline AutoSolveResult auto_solve_update(
-    FullBoardGame& game, const std::optional<std::chrono::milliseconds>& solve_time)
+    FullBoardGame& game, const SolveLimits& limits, const SolverConfig& config, SolverStats& stats)
 {
-    if (!game.start_pos().has_value()) {
-        if (const std::optional<Vector2i> pos = first_avail_pos(game); pos.has_value()) {
-            game.set_start(pos.value());
-        }
-        else {
-            return AutoSolveResult::should_stop;
-        }
+    const SolveTimer timer(stats);
+    if (!set_first_start(game, config, stats)) {
+        return AutoSolveResult::should_stop;
     }
-    const auto start_time = std::chrono::steady_clock::now();
-    const std::optional<std::chrono::time_point<std::chrono::steady_clock>> target_time
-        = solve_time.has_value() ? std::optional(start_time + solve_time.value()) : std::nullopt;
+    SolveControl control(limits, stats);
     do {
-        solve_step_local(game);
-        if (game.move_history().empty()) {
-            const std::optional<Vector2i> next = next_pos(game, game.start_pos().value());
-            game.reset_leave_barriers();
-            if (next.has_value()) {
-                game.set_start(next.value());
-            }
-            else {
-                return AutoSolveResult::should_stop;
-            }
+        if (!auto_solve_step(game, config, stats)) {
+            return AutoSolveResult::should_stop;
         }
-    } while (!game.won() && game.start_pos().has_value() && target_time.has_value()
-             && std::chrono::steady_clock::now() < target_time.value());
-    if (game.won()) {
+    } while (!game.won() && !control.should_stop(stats));
+    return game.won() ? AutoSolveResult::should_stop : AutoSolveResult::should_continue;
+}
+
+// Solves for about `solve_time`, or with no `solve_time` takes exactly one auto_solve_step
+inline AutoSolveResult auto_solve_update(
+    FullBoardGame& game,
+    const std::optional<std::chrono::milliseconds>& solve_time,
+    const SolverConfig& config,
+    SolverStats& stats)
+{
+    if (solve_time.has_value()) {
+        SolveLimits limits;
+        limits.deadline = std::chrono::steady_clock::now() + *solve_time;
+        return auto_solve_update(game, limits, config, stats);
+    }
+    const SolveTimer timer(stats);
+    if (!set_first_start(game, config, stats) || !auto_solve_step(game, config, stats)) {
         return AutoSolveResult::should_stop;
     }
-    return AutoSolveResult::should_continue;
-}
\ No newline at end of file
+    return game.won() ? AutoSolveResult::should_stop : AutoSolveResult::should_continue;
+}
+
+inline AutoSolveResult auto_solve_update(
+    FullBoardGame& game, const std::optional<std::chrono::milliseconds>& solve_time)
+{
+    SolverStats stats;
+    return auto_solve_update(game, solve_time, SolverConfig {}, stats);
+}
+
+// Runs auto_solve_update with no limits, for callers with no frame loop to return to. Returns whether the game was won.
+inline bool auto_solve(FullBoardGame& game, const SolverConfig& config, SolverStats& stats)
+{
+    auto_solve_update(game, SolveLimits {}, config, stats);
+    return game.won();
+}
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <BS_thread_pool.hpp>
+
+#include "board_io.hpp"
+#include "iterative_solver.hpp"
+
+struct GeneratorOptions {
+    int size = 10;
+    int min_barriers = 0;
+    int max_barriers = 0;
+    int count = 1000;
+    const char* output_path = nullptr;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    // Difficulty is the number of moves the pruned depth-first search makes before it finds the solution, trying start
+    // cells in row-major order
+    uint64_t min_difficulty = 0;
+    uint64_t max_difficulty = std::numeric_limits<uint64_t>::max();
+    // Gives up after this many random walks, as some sizes and barrier counts have only a few dozen unique layouts the
+    // walks reach, or none at all
+    uint64_t max_walks = 0;
+};
+
+static void print_usage()
+{
+    std::cerr << "Usage: puzzle_generator <size> <barriers or min-max> <count> <output file> [--threads n] [--seed n]\n"
+                 "                        [--min-difficulty n] [--max-difficulty n] [--max-walks n]\n";
+}
+
+static std::optional<GeneratorOptions> parse_options(const int argc, char** argv)
+{
+    if (argc < 5) {
+        return std::nullopt;
+    }
+    GeneratorOptions options;
+    const std::string_view barriers = argv[2];
+    const size_t dash = barriers.find('-');
+    if (!parse_number(argv[1], options.size) || !parse_number(barriers.substr(0, dash), options.min_barriers)
+        || !parse_number(argv[3], options.count)) {
+        return std::nullopt;
+    }
+    options.max_barriers = options.min_barriers;
+    if (dash != std::string_view::npos && !parse_number(barriers.substr(dash + 1), options.max_barriers)) {
+        return std::nullopt;
+    }
+    options.output_path = argv[4];
+    for (int i = 5; i + 1 < argc; i += 2) {
+        const std::string_view flag = argv[i];
+        bool valid = false;
+        if (flag == "--threads") {
+            valid = parse_number(argv[i + 1], options.threads);
+        }
+        else if (flag == "--seed") {
+            valid = parse_number(argv[i + 1], options.seed);
+        }
+        else if (flag == "--min-difficulty") {
+            valid = parse_number(argv[i + 1], options.min_difficulty);
+        }
+        else if (flag == "--max-difficulty") {
+            valid = parse_number(argv[i + 1], options.max_difficulty);
+        }
+        else if (flag == "--max-walks") {
+            valid = parse_number(argv[i + 1], options.max_walks);
+        }
+        if (!valid) {
+            return std::nullopt;
+        }
+    }
+    if ((argc - 5) % 2 != 0 || options.size < 1 || options.size > FullBoardGame::c_max_size || options.min_barriers < 0
+        || options.max_barriers < options.min_barriers || options.max_barriers >= options.size * options.size
+        || options.count < 1 || options.threads < 1) {
+        return std::nullopt;
+    }
+    if (options.max_walks == 0) {
+        options.max_walks = static_cast<uint64_t>(options.count) * 10000;
+    }
+    return options;
+}
+
+// Slides at random from a random start until stuck. Every prefix of the walk solves the layout whose barriers are the
+// cells it leaves empty, so those layouts are all solvable and only uniqueness is left to check.
+static FullBoardGame random_walk(const int size, std::mt19937_64& rng)
+{
+    FullBoardGame game(size);
+    game.set_start({ static_cast<int>(rng() % size), static_cast<int>(rng() % size) });
+    while (true) {
+        const int first_dir = static_cast<int>(rng() % 4);
+        bool moved = false;
+        for (int i = 0; i < 4 && !moved; ++i) {
+            moved = game.move(idx_dir((first_dir + i) % 4)).record.has_value();
+        }
+        if (!moved) {
+            return game;
+        }
+    }
+}
+
+static std::vector<Vector2i> empty_cells(const FullBoardGame& game)
+{
+    std::vector<Vector2i> cells;
+    for (int y = 0; y < game.size(); ++y) {
+        for (int x = 0; x < game.size(); ++x) {
+            if (!game.filled_at({ x, y })) {
+                cells.push_back({ x, y });
+            }
+        }
+    }
+    return cells;
+}
+
+// Zobrist hash of the barrier cells under whichever rotation or reflection hashes lowest, so that layouts which are
+// turned or mirrored copies of each other share a key. Two layouts of a run colliding is as unlikely as a false hit in
+// the transposition table.
+static uint64_t canonical_key(const FullBoardGame& game)
+{
+    const std::vector<Vector2i> barriers = game.barrier_positions();
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (int t = 0; t < 8; ++t) {
+        uint64_t key = 0;
+        for (const Vector2i barrier : barriers) {
+            key ^= FullBoardGame::cell_key(game.pos_to_idx(transform_pos(t, barrier, game.size())));
+        }
+        best = std::min(best, key);
+    }
+    return best;
+}
+
+int main(const int argc, char** argv)
+{
+    const std::optional<GeneratorOptions> options = parse_options(argc, argv);
+    if (!options.has_value()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    std::ofstream output(options->output_path);
+    if (!output) {
+        std::cerr << "Cannot open " << options->output_path << " for writing\n";
+        return EXIT_FAILURE;
+    }
+
+    // Dead positions are keyed by the board size, the filled cells and the current cell, so every candidate of the run
+    // can share one table
+    TranspositionTable table(1 << 22);
+    const SolverConfig config { .prune_degrees = true,
+                                .prune_connectivity = true,
+                                .table = &table,
+                                .reduce_symmetry = true,
+                                .constrain_endpoints = true };
+    // Rated without the table or the start reductions, which would make the rating depend on the run
+    const SolverConfig difficulty_config { .prune_degrees = true, .prune_connectivity = true };
+    std::atomic<int> accepted = 0;
+    std::atomic<uint64_t> walks = 0;
+    std::mutex output_mutex;
+    // Every layout a worker has taken to check, accepted or not
+    std::unordered_set<uint64_t> checked;
+    const auto start_time = std::chrono::steady_clock::now();
+
+    BS::thread_pool pool(options->threads);
+    BS::multi_future<void> workers = pool.submit_sequence<unsigned>(0, options->threads, [&](const unsigned worker) {
+        std::mt19937_64 rng(options->seed * options->threads + worker);
+        while (accepted.load(std::memory_order_relaxed) < options->count
+               && walks.fetch_add(1, std::memory_order_relaxed) < options->max_walks) {
+            // Unique layouts are rare, so every prefix of the walk within the barrier range is tried
+            for (FullBoardGame walk = random_walk(options->size, rng); !walk.move_history().empty(); walk.undo()) {
+                if (walk.empty_count() < options->min_barriers || walk.empty_count() > options->max_barriers) {
+                    continue;
+                }
+                FullBoardGame game(options->size);
+                game.set_barriers(empty_cells(walk));
+                // Long walks keep reaching the same few layouts, so each is checked once, by the first worker there
+                const uint64_t key = canonical_key(game);
+                if (const std::scoped_lock lock(output_mutex); !checked.insert(key).second) {
+                    continue;
+                }
+                if (check_uniqueness(game, config) != Uniqueness::unique) {
+                    continue;
+                }
+                IterativeSolver rated(game, difficulty_config);
+                rated.solve();
+                const uint64_t difficulty = rated.stats().nodes;
+                if (difficulty < options->min_difficulty || difficulty > options->max_difficulty) {
+                    continue;
+                }
+                const std::scoped_lock lock(output_mutex);
+                if (accepted.fetch_add(1, std::memory_order_relaxed) >= options->count) {
+                    break;
+                }
+                output << format_board(options->size, game.barrier_positions()) << " # solution "
+                       << format_solution(*game.start_pos(), game.move_history()) << " difficulty " << difficulty
+                       << std::endl;
+            }
+        }
+    });
+    workers.wait();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    const int written = std::min(accepted.load(), options->count);
+    std::cerr << written << " puzzles from " << std::min(walks.load(), options->max_walks) << " walks and "
+              << checked.size() << " distinct layouts in " << seconds << " s ("
+              << static_cast<double>(written) / seconds * 60.0 << " per minute)\n";
+    return written == options->count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "full_board_solver.hpp"
+
+enum class Uniqueness { none, unique, multiple };
+
+// Depth-first search over an explicit stack of frames, one per move of the path, sized from the board area when the
+// solver is made. Moves go through FullBoardGame::slide, so the search itself never touches the heap.
+class IterativeSolver {
+public:
+    IterativeSolver(const FullBoardGame& game, const SolverConfig& config)
+        : m_game(game)
+        , m_config(config)
+        , m_starts(start_candidates(game, config))
+        , m_frames(static_cast<size_t>(game.size()) * game.size() + 1)
+        , m_solution(m_frames.size())
+    {
+        m_game.reset_leave_barriers();
+        if (m_config.prune_degrees) {
+            m_game.track_degrees(true);
+        }
+        if (m_config.table != nullptr) {
+            m_game.track_hash(true);
+        }
+        m_game.reserve_scratch();
+    }
+
+    // Searches every start cell in turn, stopping at the first solution or when `limits` stop it. Returns whether a
+    // solution was found.
+    bool solve(const SolveLimits& limits = {})
+    {
+        const SolveTimer timer(m_stats);
+        m_control = SolveControl(limits, m_stats);
+        for (const Vector2i start : m_starts) {
+            begin(start);
+            if (search()) {
+                keep_solution(start);
+                return true;
+            }
+            if (m_control.stopped()) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Searches on past the first solution until a second one turns up. The first solution is kept for solution() and
+    // apply_solution(). A rotation or reflection of the layout that maps it to a different path is a second solution
+    // by itself, which usually ends the search on symmetric layouts at the first solution.
+    Uniqueness solve_unique()
+    {
+        const SolveTimer timer(m_stats);
+        const std::vector<int> symmetries = layout_symmetries(m_game);
+        m_control = {};
+        m_start.reset();
+        for (const Vector2i start : m_starts) {
+            begin(start);
+            while (search()) {
+                if (m_start.has_value()) {
+                    return Uniqueness::multiple;
+                }
+                keep_solution(start);
+                if (has_distinct_image(symmetries)) {
+                    return Uniqueness::multiple;
+                }
+                // The positions on the way to the solution are not dead, so they stay out of the table as the search
+                // backs out of them
+                m_live_depth = m_depth;
+                m_game.unslide(m_frames[--m_depth].move);
+                m_stats.undos++;
+            }
+        }
+        return m_start.has_value() ? Uniqueness::unique : Uniqueness::none;
+    }
+
+    // Whether the last solve() was stopped by its limits before it could finish
+    [[nodiscard]] bool stopped() const
+    {
+        return m_control.stopped();
+    }
+
+    [[nodiscard]] std::optional<Vector2i> start_pos() const
+    {
+        return m_start;
+    }
+
+    // The moves of the solution from start_pos, as move_history() would hold them
+    [[nodiscard]] std::vector<FullBoardGame::MoveRecord> solution() const
+    {
+        return { m_solution.begin(), m_solution.begin() + m_solution_length };
+    }
+
+    // Replays the solution on `game`, leaving it as a winning auto_solve_update would
+    void apply_solution(FullBoardGame& game) const
+    {
+        replay_solution(game, m_start, std::span(m_solution).first(m_solution_length), &FullBoardGame::MoveRecord::dir);
+    }
+
+    [[nodiscard]] const SolverStats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    struct Frame {
+        // Next direction to try from this depth
+        int next_dir = 0;
+        // Move from this depth to the next, kept to take it back
+        FullBoardGame::MoveRecord move {};
+    };
+
+    void begin(const Vector2i start)
+    {
+        m_game.reset_leave_barriers();
+        m_game.set_start(start);
+        m_stats.starts_tried++;
+        m_depth = 0;
+        m_live_depth = 0;
+        m_frames[0].next_dir = 0;
+    }
+
+    // Searches on from the current frame, leaving the path in the frames if it wins
+    bool search()
+    {
+        while (true) {
+            Frame& frame = m_frames[m_depth];
+            if (frame.next_dir < 4) {
+                if (!m_game.slide(idx_dir(frame.next_dir++), frame.move)) {
+                    continue;
+                }
+                m_stats.nodes++;
+                m_stats.max_depth = std::max(m_stats.max_depth, m_depth + 1);
+                if (m_game.empty_count() == 0) {
+                    m_depth++;
+                    return true;
+                }
+                if (m_control.should_stop(m_stats)) {
+                    return false;
+                }
+                if (should_prune(m_game, m_config, m_stats)) {
+                    m_game.unslide(frame.move);
+                    m_stats.undos++;
+                    continue;
+                }
+                m_frames[++m_depth].next_dir = 0;
+                continue;
+            }
+            // Every direction from here has failed, unless this position leads to a solution found earlier
+            if (m_depth < m_live_depth) {
+                m_live_depth = m_depth;
+            }
+            else if (m_config.table != nullptr) {
+                store_dead(*m_config.table, m_game.hash(), m_game.empty_count(), m_stats);
+            }
+            if (m_depth == 0) {
+                return false;
+            }
+            m_game.unslide(m_frames[--m_depth].move);
+            m_stats.undos++;
+        }
+    }
+
+    void keep_solution(const Vector2i start)
+    {
+        m_start = start;
+        m_solution_length = m_depth;
+        for (int d = 0; d < m_depth; ++d) {
+            m_solution[d] = m_frames[d].move;
+        }
+    }
+
+    [[nodiscard]] bool has_distinct_image(const std::vector<int>& symmetries) const
+    {
+        for (const int t : symmetries) {
+            if (transform_pos(t, *m_start, m_game.size()) != *m_start) {
+                return true;
+            }
+            for (int d = 0; d < m_solution_length; ++d) {
+                if (transform_dir(t, m_solution[d].dir) != m_solution[d].dir) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    FullBoardGame m_game;
+    SolverConfig m_config;
+    SolverStats m_stats;
+    // Applies the limits of the running solve(), and remembers after it whether they stopped it
+    SolveControl m_control;
+    std::vector<Vector2i> m_starts;
+    std::vector<Frame> m_frames;
+    int m_depth = 0;
+    // Frames below this depth lead to the solution found last
+    int m_live_depth = 0;
+    std::optional<Vector2i> m_start;
+    std::vector<FullBoardGame::MoveRecord> m_solution;
+    int m_solution_length = 0;
+};
+
+// Whether the layout of `game` has no, one or several solutions. `game` is left solved with the solution when there is
+// exactly one. The table of `config` can be shared by many layouts, as a dead position is keyed by the board size as
+// well as by its filled cells and current cell.
+inline Uniqueness check_uniqueness(FullBoardGame& game, const SolverConfig& config)
+{
+    IterativeSolver solver(game, config);
+    const Uniqueness result = solver.solve_unique();
+    if (result == Uniqueness::unique) {
+        solver.apply_solution(game);
+    }
+    return result;
+}
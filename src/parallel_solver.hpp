@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <BS_thread_pool.hpp>
+
+#include "full_board_solver.hpp"
+
+// Searches every start cell of the board at once, one pool task per start on its own copy of `game`. The first start to
+// win stops the others and its game is copied into `game`, leaving it in the same state a winning auto_solve_update
+// would: started, with the solution as its history. Any start or moves already on `game` are ignored. The deadline and
+// node budget of `limits` apply to each task, and its stop flag is passed on to the tasks about once a millisecond.
+// `stats` receives the totals of every task.
+inline SolveOutcome parallel_solve(
+    FullBoardGame& game,
+    BS::thread_pool& pool,
+    const SolverConfig& config,
+    SolverStats& stats,
+    const SolveLimits& limits = {})
+{
+    const std::vector<Vector2i> starts = start_candidates(game, config);
+    // Raised by the first win or by the caller's stop flag, and stops every task within a move
+    std::atomic<bool> stop = false;
+    std::atomic<bool> cut_short = false;
+    SolveLimits task_limits;
+    task_limits.stop = &stop;
+    task_limits.deadline = limits.deadline;
+    task_limits.node_budget = limits.node_budget;
+    if (limits.stop != nullptr) {
+        task_limits.on_progress = [&](const SolverStats&) {
+            if (limits.stop->load(std::memory_order_relaxed)) {
+                stop.store(true, std::memory_order_relaxed);
+            }
+        };
+        task_limits.progress_interval = std::chrono::milliseconds(1);
+    }
+    std::mutex result_mutex;
+    std::optional<FullBoardGame> winner;
+    const SolveTimer timer(stats);
+    BS::multi_future<void> tasks = pool.submit_sequence<size_t>(0, starts.size(), [&](const size_t i) {
+        const bool caller_stopped = limits.stop != nullptr && limits.stop->load(std::memory_order_relaxed);
+        const bool out_of_time = limits.deadline.has_value() && std::chrono::steady_clock::now() >= *limits.deadline;
+        if (stop.load(std::memory_order_relaxed) || caller_stopped || out_of_time) {
+            cut_short.store(true, std::memory_order_relaxed);
+            return;
+        }
+        FullBoardGame local = game;
+        SolverStats local_stats;
+        const bool won = solve_from_start(local, starts[i], config, local_stats, task_limits);
+        // The tasks overlap, so the wall time of the whole solve is counted instead
+        local_stats.elapsed = {};
+        const std::scoped_lock lock(result_mutex);
+        stats += local_stats;
+        if (won && !winner.has_value()) {
+            winner = std::move(local);
+            stop.store(true, std::memory_order_relaxed);
+        }
+        else if (!won && !local.move_history().empty()) {
+            // Stopped before every line from the start had failed
+            cut_short.store(true, std::memory_order_relaxed);
+        }
+    });
+    tasks.wait();
+    if (winner.has_value()) {
+        game = std::move(*winner);
+        return SolveOutcome::solved;
+    }
+    return cut_short.load(std::memory_order_relaxed) ? SolveOutcome::stopped : SolveOutcome::unsolvable;
+}
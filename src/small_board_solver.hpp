@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "iterative_solver.hpp"
+
+// Depth-first search specialized for boards of N x N cells, N at most 8. The filled cells fit in one 64-bit word, cell
+// (x, y) at bit y * 8 + x, so a slide is a masked bit scan over a ray table built at compile time, and each move makes
+// a new (filled, position) pair rather than changing one and undoing it. Pruning and the order directions and starts
+// are tried in match IterativeSolver, so both make the same moves and find the same solution, and positions hash as
+// FullBoardGame::hash() does, so both can share a transposition table. Solving goes through the same calls as
+// IterativeSolver, so run_solver takes either.
+template <int N>
+class SmallBoardSolver {
+    static_assert(N >= 1 && N <= 8);
+
+public:
+    SmallBoardSolver(const FullBoardGame& game, const SolverConfig& config)
+        : m_config(config)
+        , m_starts(start_candidates(game, config))
+    {
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                m_cell_keys[y * 8 + x] = FullBoardGame::cell_key(y * N + x);
+                m_pos_keys[y * 8 + x] = FullBoardGame::cell_key(-1 - (y * N + x));
+            }
+        }
+        m_barrier_hash = FullBoardGame::size_key(N);
+        for (const Vector2i barrier : game.barrier_positions()) {
+            m_barriers |= cell_bit(barrier);
+            m_barrier_hash ^= m_cell_keys[barrier.y * 8 + barrier.x];
+        }
+    }
+
+    bool solve(const SolveLimits& limits = {})
+    {
+        const SolveTimer timer(m_stats);
+        m_control = SolveControl(limits, m_stats);
+        for (const Vector2i start : m_starts) {
+            m_stats.starts_tried++;
+            const int pos = start.y * 8 + start.x;
+            if (search(m_barriers | cell_bit(start), m_barrier_hash ^ m_cell_keys[pos], pos, 0)) {
+                m_start = start;
+                return true;
+            }
+            if (m_control.stopped()) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool stopped() const
+    {
+        return m_control.stopped();
+    }
+
+    [[nodiscard]] std::optional<Vector2i> start_pos() const
+    {
+        return m_start;
+    }
+
+    void apply_solution(FullBoardGame& game) const
+    {
+        replay_solution(game, m_start, std::span(m_path).first(m_length));
+    }
+
+    [[nodiscard]] const SolverStats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    using Rays = std::array<std::array<uint64_t, 64>, 4>;
+
+    static constexpr uint64_t c_board = [] {
+        uint64_t board = 0;
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                board |= uint64_t { 1 } << (y * 8 + x);
+            }
+        }
+        return board;
+    }();
+    static constexpr uint64_t c_not_first_col = 0xfefefefefefefefe;
+    static constexpr uint64_t c_not_last_col = 0x7f7f7f7f7f7f7f7f;
+
+    // For each direction and cell, the board cells strictly beyond the cell in that direction
+    static constexpr Rays c_rays = [] {
+        Rays rays {};
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                for (int dir = 0; dir < 4; ++dir) {
+                    const int dx = dir == 1 ? 1 : dir == 3 ? -1 : 0;
+                    const int dy = dir == 2 ? 1 : dir == 0 ? -1 : 0;
+                    for (int cx = x + dx, cy = y + dy; cx >= 0 && cx < N && cy >= 0 && cy < N; cx += dx, cy += dy) {
+                        rays[dir][y * 8 + x] |= uint64_t { 1 } << (cy * 8 + cx);
+                    }
+                }
+            }
+        }
+        return rays;
+    }();
+
+    static uint64_t cell_bit(const Vector2i pos)
+    {
+        return uint64_t { 1 } << (pos.y * 8 + pos.x);
+    }
+
+    // Cells with a neighbor in `cells`, in each direction
+    static uint64_t from_west(const uint64_t cells)
+    {
+        return (cells << 1) & c_not_first_col;
+    }
+
+    static uint64_t from_east(const uint64_t cells)
+    {
+        return (cells >> 1) & c_not_last_col;
+    }
+
+    static uint64_t neighbors(const uint64_t cells)
+    {
+        return (from_west(cells) | from_east(cells) | cells << 8 | cells >> 8) & c_board;
+    }
+
+    // Cells a slide from `pos` in direction `dir` covers, which is none when the first of them is filled
+    static uint64_t slide_cells(const uint64_t filled, const int pos, const int dir)
+    {
+        const uint64_t ray = c_rays[dir][pos];
+        const uint64_t hit = ray & filled;
+        if (hit == 0) {
+            return ray;
+        }
+        // East and south go towards higher bits, so they stop below the lowest filled cell, and north and west above
+        // the highest
+        if (dir == 1 || dir == 2) {
+            return ray & ((hit & (~hit + 1)) - 1);
+        }
+        return ray & ~((uint64_t { 2 } << (63 - std::countl_zero(hit))) - 1);
+    }
+
+    // As FullBoardGame::empty_degrees_feasible, with the current position counting as a way into its neighbors
+    static bool degrees_feasible(const uint64_t empty, const int pos)
+    {
+        const uint64_t open = empty | uint64_t { 1 } << pos;
+        const uint64_t before = from_west(open);
+        const uint64_t after = from_east(open);
+        const uint64_t prev_line = open << 8;
+        const uint64_t next_line = open >> 8;
+        const uint64_t isolated = empty & ~(before | after | prev_line | next_line);
+        const uint64_t dead_ends
+            = empty & (before ^ after ^ prev_line ^ next_line) & ~((before & after) | (prev_line & next_line));
+        return isolated == 0 && std::popcount(dead_ends) <= 1;
+    }
+
+    // As FullBoardGame::empty_cells_connected
+    static bool cells_connected(const uint64_t empty, const int pos)
+    {
+        uint64_t reached = neighbors(uint64_t { 1 } << pos) & empty;
+        while (true) {
+            const uint64_t next = reached | (neighbors(reached) & empty);
+            if (next == reached) {
+                return reached == empty;
+            }
+            reached = next;
+        }
+    }
+
+    // Hash of the filled cells with `covered` filled as well
+    uint64_t cover_hash(uint64_t hash, uint64_t covered) const
+    {
+        for (; covered != 0; covered &= covered - 1) {
+            hash ^= m_cell_keys[std::countr_zero(covered)];
+        }
+        return hash;
+    }
+
+    // Whether the position reached by the last move can be abandoned, checked in the order should_prune uses
+    bool prune(const uint64_t filled, const uint64_t hash, const int pos)
+    {
+        const uint64_t empty = ~filled & c_board;
+        if (m_config.prune_degrees && !degrees_feasible(empty, pos)) {
+            m_stats.pruned_degrees++;
+            return true;
+        }
+        if (m_config.table != nullptr) {
+            if (m_config.table->probe(hash ^ m_pos_keys[pos])) {
+                m_stats.pruned_table++;
+                return true;
+            }
+            m_stats.table_misses++;
+        }
+        if (m_config.prune_connectivity && !cells_connected(empty, pos)) {
+            m_stats.pruned_connectivity++;
+            return true;
+        }
+        return false;
+    }
+
+    // `hash` covers the filled cells and the size, and leaves the position out
+    bool search(const uint64_t filled, const uint64_t hash, const int pos, const int depth)
+    {
+        for (int dir = 0; dir < 4; ++dir) {
+            const uint64_t covered = slide_cells(filled, pos, dir);
+            if (covered == 0) {
+                continue;
+            }
+            const uint64_t next_filled = filled | covered;
+            const int next_pos = dir == 1 || dir == 2 ? 63 - std::countl_zero(covered) : std::countr_zero(covered);
+            m_stats.nodes++;
+            m_stats.max_depth = std::max(m_stats.max_depth, depth + 1);
+            m_path[depth] = idx_dir(dir);
+            if (next_filled == c_board) {
+                m_length = depth + 1;
+                return true;
+            }
+            if (m_control.should_stop(m_stats)) {
+                return false;
+            }
+            const uint64_t next_hash = m_config.table != nullptr ? cover_hash(hash, covered) : 0;
+            if (!prune(next_filled, next_hash, next_pos) && search(next_filled, next_hash, next_pos, depth + 1)) {
+                return true;
+            }
+            if (m_control.stopped()) {
+                return false;
+            }
+            m_stats.undos++;
+        }
+        // Every direction from here has failed
+        if (m_config.table != nullptr) {
+            store_dead(*m_config.table, hash ^ m_pos_keys[pos], std::popcount(~filled & c_board), m_stats);
+        }
+        return false;
+    }
+
+    SolverConfig m_config;
+    SolverStats m_stats;
+    SolveControl m_control;
+    std::vector<Vector2i> m_starts;
+    uint64_t m_barriers = 0;
+    // FullBoardGame::hash() keys by bit, for the filled cells and for the current position
+    std::array<uint64_t, 64> m_cell_keys {};
+    std::array<uint64_t, 64> m_pos_keys {};
+    uint64_t m_barrier_hash = 0;
+    std::optional<Vector2i> m_start;
+    std::array<Direction, N * N> m_path {};
+    int m_length = 0;
+};
+
+// Solves `game` with a `Solver` made for it, adding to `stats` and leaving any solution on `game`
+template <typename Solver>
+SolveOutcome run_solver(FullBoardGame& game, const SolverConfig& config, SolverStats& stats, const SolveLimits& limits)
+{
+    Solver solver(game, config);
+    const bool won = solver.solve(limits);
+    solver.apply_solution(game);
+    stats += solver.stats();
+    return won ? SolveOutcome::solved : solver.stopped() ? SolveOutcome::stopped : SolveOutcome::unsolvable;
+}
+
+// Solves `game` as SolveLimits allow, with the engine specialized for its size when it is 8 or less and with
+// IterativeSolver otherwise. A win leaves `game` as a winning auto_solve_update would; any start or moves already on it
+// are ignored.
+inline SolveOutcome solve_by_size(
+    FullBoardGame& game, const SolverConfig& config, SolverStats& stats, const SolveLimits& limits = {})
+{
+    switch (game.size()) {
+    case 1:
+        return run_solver<SmallBoardSolver<1>>(game, config, stats, limits);
+    case 2:
+        return run_solver<SmallBoardSolver<2>>(game, config, stats, limits);
+    case 3:
+        return run_solver<SmallBoardSolver<3>>(game, config, stats, limits);
+    case 4:
+        return run_solver<SmallBoardSolver<4>>(game, config, stats, limits);
+    case 5:
+        return run_solver<SmallBoardSolver<5>>(game, config, stats, limits);
+    case 6:
+        return run_solver<SmallBoardSolver<6>>(game, config, stats, limits);
+    case 7:
+        return run_solver<SmallBoardSolver<7>>(game, config, stats, limits);
+    case 8:
+        return run_solver<SmallBoardSolver<8>>(game, config, stats, limits);
+    default:
+        return run_solver<IterativeSolver>(game, config, stats, limits);
+    }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "full_board_solver.hpp"
+
+struct StartCount {
+    Vector2i start;
+    uint64_t solutions;
+};
+
+struct SolutionCount {
+    // Counts saturate at the largest uint64_t, which then means at least that many
+    uint64_t total = 0;
+    // Every non-barrier cell in row-major order
+    std::vector<StartCount> per_start;
+    // Positions whose counts are memoized at the end, and how often the memo was full and emptied on the way
+    size_t memo_entries = 0;
+    size_t memo_clears = 0;
+    // False when the limits stopped the count, which leaves every count a lower bound
+    bool complete = true;
+};
+
+// Counts the distinct move sequences that fill the board. The number of ways to finish only depends on the filled cells
+// and the current position, not on how they were reached, so each such position is counted once and remembered for
+// every later path and every start cell that reaches it. The walk keeps its own stack, so board size is only bounded
+// by time and by the memo, which is emptied whenever it holds `max_memo_entries` positions. An entry takes about 100
+// bytes plus 8 per board row.
+class SolutionCounter {
+public:
+    static constexpr size_t c_default_max_memo_entries = size_t { 1 } << 20;
+
+    // Uses the pruning of `config`, and its start reductions to skip starts it would not try. The transposition table
+    // is left out, as a hash collision there would make a count wrong rather than slow. `limits` apply to the whole
+    // count, with a node for each slide.
+    SolutionCounter(
+        const FullBoardGame& game,
+        const SolverConfig& config,
+        const SolveLimits& limits = {},
+        const size_t max_memo_entries = c_default_max_memo_entries)
+        : m_game(game)
+        , m_config(config)
+        , m_limits(limits)
+        , m_control(m_limits, m_stats)
+        , m_max_memo_entries(std::max<size_t>(max_memo_entries, 1))
+    {
+        m_config.table = nullptr;
+        m_game.reset_leave_barriers();
+        if (m_config.prune_degrees) {
+            m_game.track_degrees(true);
+        }
+        m_game.track_hash(true);
+    }
+
+    // Solutions from `start`. A solution needs at least one move, as in auto_solve_update. Once the limits have stopped
+    // the count this is a lower bound, and 0 for every later start.
+    uint64_t count_from(const Vector2i start)
+    {
+        m_game.reset_leave_barriers();
+        m_game.set_start(start);
+        if (m_stopped || m_game.empty_count() == 0 || m_game.start_pos() != start) {
+            return 0;
+        }
+        return count();
+    }
+
+    [[nodiscard]] bool stopped() const
+    {
+        return m_stopped;
+    }
+
+    SolutionCount count_all()
+    {
+        SolutionCount result;
+        std::unordered_map<int, uint64_t> candidate_counts;
+        for (const Vector2i start : start_candidates(m_game, m_config)) {
+            candidate_counts[m_game.pos_to_idx(start)] = count_from(start);
+        }
+        // Symmetric starts have the same count as the first cell of their orbit, which is the one that was counted
+        const std::vector<int> symmetries
+            = m_config.reduce_symmetry ? layout_symmetries(m_game) : std::vector<int> { 0 };
+        for (int idx = 0; idx < m_game.size() * m_game.size(); ++idx) {
+            const Vector2i pos = m_game.idx_to_pos(idx);
+            if (m_game.barrier_at(pos)) {
+                continue;
+            }
+            int representative = idx;
+            for (const int t : symmetries) {
+                representative = std::min(representative, m_game.pos_to_idx(transform_pos(t, pos, m_game.size())));
+            }
+            const auto it = candidate_counts.find(representative);
+            const uint64_t solutions = it != candidate_counts.end() ? it->second : 0;
+            result.per_start.push_back({ .start = pos, .solutions = solutions });
+            result.total = saturating_add(result.total, solutions);
+        }
+        result.memo_entries = m_memo.size();
+        result.memo_clears = m_memo_clears;
+        result.complete = !m_stopped;
+        return result;
+    }
+
+private:
+    // A position on the walk, with the move that reached it and the count of the directions tried from it so far
+    struct Frame {
+        FullBoardGame::MoveRecord record;
+        int next_dir = 0;
+        uint64_t total = 0;
+    };
+
+    struct KeyHash {
+        size_t operator()(const std::vector<uint64_t>& key) const
+        {
+            return static_cast<size_t>(key.back());
+        }
+    };
+
+    static uint64_t saturating_add(const uint64_t a, const uint64_t b)
+    {
+        return a > std::numeric_limits<uint64_t>::max() - b ? std::numeric_limits<uint64_t>::max() : a + b;
+    }
+
+    // Filled rows, then the current cell, then the hash of both for the table to bucket by
+    void make_key(std::vector<uint64_t>& key) const
+    {
+        key.assign(m_game.filled_rows().begin(), m_game.filled_rows().end());
+        key.push_back(static_cast<uint64_t>(m_game.pos_to_idx(*m_game.current_pos())));
+        key.push_back(m_game.hash());
+    }
+
+    void remember(const uint64_t total)
+    {
+        if (m_memo.size() >= m_max_memo_entries) {
+            m_memo.clear();
+            m_memo_clears++;
+        }
+        make_key(m_key);
+        m_memo.emplace(m_key, total);
+    }
+
+    // Ways to fill the board from the current position, walked depth first
+    uint64_t count()
+    {
+        make_key(m_key);
+        if (const auto it = m_memo.find(m_key); it != m_memo.end()) {
+            return it->second;
+        }
+        m_frames.assign(1, Frame {});
+        while (true) {
+            Frame& top = m_frames.back();
+            if (top.next_dir < 4) {
+                FullBoardGame::MoveRecord record;
+                if (!m_game.slide(idx_dir(top.next_dir++), record)) {
+                    continue;
+                }
+                m_stats.nodes++;
+                if (m_control.should_stop(m_stats)) {
+                    // Leaves the partial totals out of the memo, where they would be taken for whole ones
+                    m_stopped = true;
+                    uint64_t total = 0;
+                    for (const Frame& frame : m_frames) {
+                        total = saturating_add(total, frame.total);
+                    }
+                    return total;
+                }
+                if (m_game.empty_count() == 0) {
+                    top.total = saturating_add(top.total, 1);
+                }
+                else if (!should_prune(m_game, m_config, m_stats)) {
+                    make_key(m_key);
+                    const auto it = m_memo.find(m_key);
+                    if (it == m_memo.end()) {
+                        m_frames.push_back({ .record = record, .next_dir = 0, .total = 0 });
+                        continue;
+                    }
+                    top.total = saturating_add(top.total, it->second);
+                }
+                m_game.unslide(record);
+                continue;
+            }
+            const uint64_t total = top.total;
+            remember(total);
+            if (m_frames.size() == 1) {
+                return total;
+            }
+            const FullBoardGame::MoveRecord record = top.record;
+            m_frames.pop_back();
+            m_game.unslide(record);
+            m_frames.back().total = saturating_add(m_frames.back().total, total);
+        }
+    }
+
+    FullBoardGame m_game;
+    SolverConfig m_config;
+    SolverStats m_stats;
+    SolveLimits m_limits;
+    SolveControl m_control;
+    bool m_stopped = false;
+    std::vector<Frame> m_frames;
+    std::vector<uint64_t> m_key;
+    std::unordered_map<std::vector<uint64_t>, uint64_t, KeyHash> m_memo;
+    size_t m_max_memo_entries;
+    size_t m_memo_clears = 0;
+};
+
+inline SolutionCount count_solutions(
+    const FullBoardGame& game, const SolverConfig& config, const SolveLimits& limits = {})
+{
+    SolutionCounter counter(game, config, limits);
+    return counter.count_all();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "full_board_game.hpp"
+
+// The eight rotations and reflections of a square board, numbered 0 to 7. Transform t turns the board a quarter turn
+// clockwise t % 4 times, then mirrors it left to right if t >= 4. Transform 0 is the identity. Slides only depend on
+// which cells are filled along a line, so a transformed move on a transformed board slides to the transformed cell.
+inline Vector2i transform_pos(const int transform, const Vector2i pos, const int size)
+{
+    Vector2i result = pos;
+    for (int i = 0; i < transform % 4; ++i) {
+        result = { size - 1 - result.y, result.x };
+    }
+    if (transform >= 4) {
+        result.x = size - 1 - result.x;
+    }
+    return result;
+}
+
+inline Direction transform_dir(const int transform, const Direction dir)
+{
+    const Direction turned = idx_dir((dir_idx(dir) + transform % 4) % 4);
+    if (transform >= 4 && (turned == Direction::east || turned == Direction::west)) {
+        return turned == Direction::east ? Direction::west : Direction::east;
+    }
+    return turned;
+}
+
+// Transforms that map the barrier layout of `game` onto itself, starting with the identity
+inline std::vector<int> layout_symmetries(const FullBoardGame& game)
+{
+    std::vector<int> symmetries { 0 };
+    for (int t = 1; t < 8; ++t) {
+        bool symmetric = true;
+        for (const Vector2i barrier : game.barrier_positions()) {
+            if (!game.barrier_at(transform_pos(t, barrier, game.size()))) {
+                symmetric = false;
+                break;
+            }
+        }
+        if (symmetric) {
+            symmetries.push_back(t);
+        }
+    }
+    return symmetries;
+}
+
+// Whether `pos` comes first in row-major order among the cells `symmetries` map it to. A start cell can only have a
+// solution if the first cell of its orbit does, so the others need not be tried.
+inline bool is_orbit_representative(const FullBoardGame& game, const std::vector<int>& symmetries, const Vector2i pos)
+{
+    for (const int t : symmetries) {
+        if (game.pos_to_idx(transform_pos(t, pos, game.size())) < game.pos_to_idx(pos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
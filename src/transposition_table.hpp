@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+enum class ReplacementPolicy {
+    // A new entry always takes the slot over
+    always,
+    // A new entry only takes the slot over from one with no more empty cells, which was cheaper to prove dead
+    prefer_larger,
+};
+
+enum class StoreResult {
+    // The slot was free or already held the position
+    stored,
+    // The position took the slot over from another one
+    evicted,
+    // The replacement policy kept the other position
+    rejected,
+};
+
+// Fixed-size table of position hashes proven to have no solution. Each slot is a single atomic word holding the upper
+// hash bits and the number of empty cells of the position, so any number of threads can probe and store without locks
+// and never see a torn entry. Nothing else is shared between the threads: the table keeps no counters of its own, and
+// the solvers count hits, misses, stores and evictions in their own SolverStats. Hashes must tell apart every position
+// stored, which FullBoardGame::hash does across board sizes as well.
+class TranspositionTable {
+public:
+    // The capacity is rounded down to a power of two slots of 8 bytes each
+    explicit TranspositionTable(const size_t capacity, const ReplacementPolicy policy = ReplacementPolicy::always)
+        : m_mask(std::bit_floor(std::max(capacity, size_t { 1 })) - 1)
+        , m_slots(std::make_unique<std::atomic<uint64_t>[]>(m_mask + 1))
+        , m_policy(policy)
+    {
+        clear();
+    }
+
+    [[nodiscard]] bool probe(const uint64_t hash)
+    {
+        const uint64_t entry = m_slots[hash & m_mask].load(std::memory_order_relaxed);
+        return entry != 0 && (entry & c_tag_mask) == (hash & c_tag_mask);
+    }
+
+    // Records a position with `empty_cells` (at least one) empty cells as having no solution
+    StoreResult store(const uint64_t hash, const int empty_cells)
+    {
+        const uint64_t entry = (hash & c_tag_mask) | std::min<uint64_t>(empty_cells, c_weight_mask);
+        std::atomic<uint64_t>& slot = m_slots[hash & m_mask];
+        const uint64_t old = slot.load(std::memory_order_relaxed);
+        if (old == entry) {
+            return StoreResult::stored;
+        }
+        StoreResult result = StoreResult::stored;
+        if (old != 0 && (old & c_tag_mask) != (hash & c_tag_mask)) {
+            if (m_policy == ReplacementPolicy::prefer_larger && (old & c_weight_mask) > (entry & c_weight_mask)) {
+                return StoreResult::rejected;
+            }
+            result = StoreResult::evicted;
+        }
+        slot.store(entry, std::memory_order_relaxed);
+        return result;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+private:
+    static constexpr uint64_t c_weight_mask = 0xffff;
+    static constexpr uint64_t c_tag_mask = ~c_weight_mask;
+
+    size_t m_mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_slots;
+    ReplacementPolicy m_policy;
+};
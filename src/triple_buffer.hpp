@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest of a stream of values from one writer thread to one reader thread without locks or waiting. The
+// writer fills its back slot and swaps it for the middle one, and the reader swaps its front slot for the middle one
+// when something newer was put there, so neither ever touches the slot the other holds. Values the reader doesn't get
+// to in time are overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial)
+        : m_slots { initial, initial, initial }
+    {
+    }
+
+    // Slot the writer fills before publish()
+    T& back()
+    {
+        return m_slots[m_back];
+    }
+
+    // Makes the back slot the newest value, and gives the writer the previous middle slot to fill next
+    void publish()
+    {
+        m_back = m_middle.exchange(static_cast<uint8_t>(m_back | c_fresh), std::memory_order_acq_rel) & c_index_mask;
+    }
+
+    // Moves the newest value published since the last call to front(). Returns whether there was one.
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & c_fresh) == 0) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & c_index_mask;
+        return true;
+    }
+
+    // Value the reader took last
+    [[nodiscard]] const T& front() const
+    {
+        return m_slots[m_front];
+    }
+
+private:
+    // The middle index is marked fresh by publish() and unmarked by acquire()
+    static constexpr uint8_t c_fresh = 4;
+    static constexpr uint8_t c_index_mask = 3;
+
+    std::array<T, 3> m_slots;
+    // Kept on separate cache lines so the two threads only share the middle index
+    alignas(64) std::atomic<uint8_t> m_middle = 1;
+    alignas(64) uint8_t m_back = 0;
+    alignas(64) uint8_t m_front = 2;
+};
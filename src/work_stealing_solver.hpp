@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <BS_thread_pool.hpp>
+
+#include "full_board_solver.hpp"
+
+struct WorkerStats {
+    // Moves made while searching, not counting the moves replayed to reach a stolen branch
+    uint64_t nodes = 0;
+    uint64_t steals = 0;
+};
+
+// Depth-first search shared by several workers. Each worker searches its own copy of the game and publishes its stack
+// as one atomic word per depth. A worker that runs out of start cells steals the unclaimed directions closest to the
+// root of another worker's stack, so a single start that holds most of the tree is still spread across every worker.
+// The deadline and node budget of `limits` apply to each worker, and its progress callback is not called.
+class WorkStealingSearch {
+public:
+    WorkStealingSearch(
+        const FullBoardGame& game, const SolverConfig& config, const int worker_count, const SolveLimits& limits = {})
+        : m_game(game)
+        , m_config(config)
+        , m_starts(start_candidates(game, config))
+        , m_worker_count(worker_count)
+        , m_workers(std::make_unique<Worker[]>(worker_count))
+    {
+        m_limits.stop = limits.stop;
+        m_limits.deadline = limits.deadline;
+        m_limits.node_budget = limits.node_budget;
+        m_game.reset_leave_barriers();
+        if (m_config.prune_degrees) {
+            m_game.track_degrees(true);
+        }
+        if (m_config.table != nullptr) {
+            m_game.track_hash(true);
+        }
+        const int max_depth = game.size() * game.size();
+        for (int i = 0; i < worker_count; ++i) {
+            m_workers[i].frames = std::make_unique<std::atomic<uint64_t>[]>(max_depth + 1);
+            for (int d = 0; d <= max_depth; ++d) {
+                m_workers[i].frames[d].store(0, std::memory_order_relaxed);
+            }
+            m_workers[i].incomplete.resize(max_depth + 1);
+        }
+    }
+
+    // Runs worker `id` until a solution is found, the limits stop it, or no work is left. Call once for each id. Only
+    // work taken counts towards the end of the search, not the workers, so the pool may run them one after another
+    // when it has fewer free threads than workers.
+    void run_worker(const int id)
+    {
+        FullBoardGame game = m_game;
+        SolveControl control(m_limits, m_workers[id].solver_stats);
+        while (acquire_work(id, game)) {
+            search(id, game, control);
+            m_busy.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    [[nodiscard]] const std::optional<FullBoardGame>& winner() const
+    {
+        return m_winner;
+    }
+
+    // Whether the limits ended the search before it was decided
+    [[nodiscard]] bool stopped() const
+    {
+        return m_stopped.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] WorkerStats worker_stats(const int id) const
+    {
+        return m_workers[id].stats;
+    }
+
+    [[nodiscard]] SolverStats solver_stats() const
+    {
+        SolverStats total;
+        for (int i = 0; i < m_worker_count; ++i) {
+            total += m_workers[i].solver_stats;
+        }
+        return total;
+    }
+
+private:
+    // A frame word holds the directions from that depth no worker has claimed yet, whether any were stolen, the
+    // direction of the move into that depth and a generation the owner bumps on every push and pop, so a thief's
+    // compare-exchange fails if the owner left the frame after the thief read it.
+    static constexpr uint64_t c_untried_mask = 0xf;
+    static constexpr uint64_t c_stolen_bit = 0x10;
+    static constexpr int c_in_dir_shift = 5;
+    static constexpr int c_generation_shift = 32;
+
+    struct alignas(64) Worker {
+        std::unique_ptr<std::atomic<uint64_t>[]> frames;
+        std::atomic<int> depth = 0;
+        std::atomic<int> start = 0;
+        // Only touched by the owner
+        int base = 0;
+        std::vector<bool> incomplete;
+        std::vector<Direction> path;
+        WorkerStats stats;
+        SolverStats solver_stats;
+    };
+
+    static uint64_t frame_word(const uint64_t prev, const Direction in_dir, const uint64_t untried)
+    {
+        const uint64_t generation = (prev >> c_generation_shift) + 1;
+        return generation << c_generation_shift | static_cast<uint64_t>(dir_idx(in_dir)) << c_in_dir_shift | untried;
+    }
+
+    static Direction frame_in_dir(const uint64_t word)
+    {
+        return idx_dir(static_cast<int>(word >> c_in_dir_shift) & 3);
+    }
+
+    void push(Worker& worker, const int depth, const Direction in_dir, const uint64_t untried)
+    {
+        std::atomic<uint64_t>& frame = worker.frames[depth];
+        frame.store(frame_word(frame.load(std::memory_order_relaxed), in_dir, untried), std::memory_order_release);
+        worker.incomplete[depth] = false;
+    }
+
+    static void pop(Worker& worker, const int depth)
+    {
+        std::atomic<uint64_t>& frame = worker.frames[depth];
+        frame.store(frame_word(frame.load(std::memory_order_relaxed), Direction::north, 0), std::memory_order_release);
+    }
+
+    void report_win(const FullBoardGame& game)
+    {
+        const std::scoped_lock lock(m_winner_mutex);
+        if (!m_winner.has_value()) {
+            m_winner = game;
+        }
+        m_done.store(true, std::memory_order_relaxed);
+    }
+
+    // Leaves `game` on the root of a new piece of work, published as the worker's stack and counted in m_busy until
+    // the search of it returns. Returns false once the search is over.
+    bool acquire_work(const int id, FullBoardGame& game)
+    {
+        Worker& self = m_workers[id];
+        if (!m_done.load(std::memory_order_relaxed)) {
+            // Counted before the start is taken, so the count never reads zero while a start is on its way to a worker
+            m_busy.fetch_add(1, std::memory_order_acq_rel);
+            const size_t start = m_next_start.fetch_add(1, std::memory_order_relaxed);
+            if (start < m_starts.size()) {
+                game.reset_leave_barriers();
+                game.set_start(m_starts[start]);
+                self.solver_stats.starts_tried++;
+                self.start.store(static_cast<int>(start), std::memory_order_release);
+                self.base = 0;
+                push(self, 0, Direction::north, c_untried_mask);
+                self.depth.store(0, std::memory_order_relaxed);
+                return true;
+            }
+            m_busy.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        // The starts are all taken, so unclaimed directions only sit on the stacks of busy workers, and none are left
+        // once no worker is busy
+        while (!m_done.load(std::memory_order_relaxed) && m_busy.load(std::memory_order_acquire) != 0) {
+            if (steal(id, game)) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    bool steal(const int id, FullBoardGame& game)
+    {
+        Worker& self = m_workers[id];
+        for (int k = 1; k < m_worker_count; ++k) {
+            Worker& victim = m_workers[(id + k) % m_worker_count];
+            const int top = victim.depth.load(std::memory_order_relaxed);
+            for (int d = 0; d <= top && !m_done.load(std::memory_order_relaxed); ++d) {
+                uint64_t word = victim.frames[d].load(std::memory_order_acquire);
+                if ((word & c_untried_mask) == 0) {
+                    continue;
+                }
+                // Take the direction the owner would have tried last
+                const uint64_t dir_bit = std::bit_floor(word & c_untried_mask);
+                // Acquire loads, so that if the victim has moved on since `word`, its pop of depth d is visible to the
+                // compare-exchange below, which then fails
+                const int start = victim.start.load(std::memory_order_acquire);
+                self.path.clear();
+                for (int j = 1; j <= d; ++j) {
+                    self.path.push_back(frame_in_dir(victim.frames[j].load(std::memory_order_acquire)));
+                }
+                // Counted busy before the claim, so the count cannot read zero between the victim finishing and the
+                // thief taking over the branch. Succeeds only if the victim has not left depth d since `word` was
+                // read, so the path is still its own.
+                m_busy.fetch_add(1, std::memory_order_acq_rel);
+                if (!victim.frames[d].compare_exchange_strong(
+                        word, (word & ~dir_bit) | c_stolen_bit, std::memory_order_acq_rel)) {
+                    m_busy.fetch_sub(1, std::memory_order_acq_rel);
+                    continue;
+                }
+                self.stats.steals++;
+                if (begin_stolen(self, game, start, std::countr_zero(dir_bit))) {
+                    return true;
+                }
+                m_busy.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+        return false;
+    }
+
+    // Replays the stolen path and direction. Returns whether there is anything left to search below it.
+    bool begin_stolen(Worker& self, FullBoardGame& game, const int start, const int dir)
+    {
+        game.reset_leave_barriers();
+        game.set_start(m_starts[start]);
+        for (const Direction step : self.path) {
+            game.move(step);
+        }
+        if (!game.move(idx_dir(dir)).record.has_value()) {
+            return false;
+        }
+        self.stats.nodes++;
+        self.solver_stats.nodes++;
+        if (game.won()) {
+            report_win(game);
+            return false;
+        }
+        if (should_prune(game, m_config, self.solver_stats)) {
+            return false;
+        }
+        self.start.store(start, std::memory_order_release);
+        push(self, 0, Direction::north, 0);
+        for (int j = 0; j < static_cast<int>(self.path.size()); ++j) {
+            push(self, j + 1, self.path[j], 0);
+        }
+        self.base = static_cast<int>(self.path.size()) + 1;
+        push(self, self.base, idx_dir(dir), c_untried_mask);
+        self.depth.store(self.base, std::memory_order_relaxed);
+        return true;
+    }
+
+    void search(const int id, FullBoardGame& game, SolveControl& control)
+    {
+        Worker& self = m_workers[id];
+        int depth = self.base;
+        while (!m_done.load(std::memory_order_relaxed)) {
+            if (control.should_stop(self.solver_stats)) {
+                // Nothing below the stack is proven dead, so it is left as it is
+                m_stopped.store(true, std::memory_order_relaxed);
+                m_done.store(true, std::memory_order_relaxed);
+                return;
+            }
+            std::atomic<uint64_t>& frame = self.frames[depth];
+            uint64_t word = frame.load(std::memory_order_relaxed);
+            uint64_t dir_bit = 0;
+            while ((word & c_untried_mask) != 0) {
+                const uint64_t lowest = word & (~word + 1);
+                if (frame.compare_exchange_weak(word, word & ~lowest, std::memory_order_relaxed)) {
+                    dir_bit = lowest;
+                    break;
+                }
+            }
+            if (dir_bit != 0) {
+                const Direction dir = idx_dir(std::countr_zero(dir_bit));
+                if (!game.move(dir).record.has_value()) {
+                    continue;
+                }
+                self.stats.nodes++;
+                self.solver_stats.nodes++;
+                self.solver_stats.max_depth
+                    = std::max(self.solver_stats.max_depth, static_cast<int>(game.move_history().size()));
+                if (game.won()) {
+                    report_win(game);
+                    return;
+                }
+                if (should_prune(game, m_config, self.solver_stats)) {
+                    game.undo();
+                    self.solver_stats.undos++;
+                    continue;
+                }
+                depth++;
+                push(self, depth, dir, c_untried_mask);
+                self.depth.store(depth, std::memory_order_relaxed);
+                continue;
+            }
+            // Every direction from here is claimed. The position is only proven dead if none went to a thief, since a
+            // stolen branch may still be running.
+            const bool incomplete = self.incomplete[depth] || (word & c_stolen_bit) != 0;
+            if (m_config.table != nullptr && !incomplete) {
+                store_dead(*m_config.table, game.hash(), game.empty_count(), self.solver_stats);
+            }
+            pop(self, depth);
+            if (depth == self.base) {
+                return;
+            }
+            game.undo();
+            self.solver_stats.undos++;
+            depth--;
+            self.incomplete[depth] = self.incomplete[depth] || incomplete;
+            self.depth.store(depth, std::memory_order_relaxed);
+        }
+    }
+
+    FullBoardGame m_game;
+    SolverConfig m_config;
+    SolveLimits m_limits;
+    std::vector<Vector2i> m_starts;
+    int m_worker_count;
+    std::unique_ptr<Worker[]> m_workers;
+    alignas(64) std::atomic<size_t> m_next_start = 0;
+    // Workers searching a branch, or about to take a start or a stolen branch
+    alignas(64) std::atomic<int> m_busy = 0;
+    // Raised by a win or by the limits, and ends the search
+    alignas(64) std::atomic<bool> m_done = false;
+    std::atomic<bool> m_stopped = false;
+    std::mutex m_winner_mutex;
+    std::optional<FullBoardGame> m_winner;
+};
+
+// Solves `game` with one work-stealing worker per pool thread, as SolveLimits allow. A win leaves `game` started with
+// the solution as its history, as after a winning auto_solve_update; any start or moves already on it are ignored.
+// `worker_stats` receives one entry per worker.
+inline SolveOutcome work_stealing_solve(
+    FullBoardGame& game,
+    BS::thread_pool& pool,
+    const SolverConfig& config,
+    SolverStats& stats,
+    std::vector<WorkerStats>& worker_stats,
+    const SolveLimits& limits = {})
+{
+    const int worker_count = static_cast<int>(pool.get_thread_count());
+    WorkStealingSearch search(game, config, worker_count, limits);
+    {
+        const SolveTimer timer(stats);
+        BS::multi_future<void> workers
+            = pool.submit_sequence<int>(0, worker_count, [&search](const int id) { search.run_worker(id); });
+        workers.wait();
+    }
+    stats += search.solver_stats();
+    worker_stats.clear();
+    for (int i = 0; i < worker_count; ++i) {
+        worker_stats.push_back(search.worker_stats(i));
+    }
+    if (search.winner().has_value()) {
+        game = *search.winner();
+        return SolveOutcome::solved;
+    }
+    return search.stopped() ? SolveOutcome::stopped : SolveOutcome::unsolvable;
+}
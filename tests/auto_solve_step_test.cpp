@@ -0,0 +1,41 @@
+#include <optional>
+#include <random>
+#include <string>
+
+#include "full_board_solver.hpp"
+#include "test_support.hpp"
+
+// The [S] key steps the solve with auto_solve_update and no time, which must take one step at a time: a move, or the
+// move to the next start cell once the current one has failed, and never both
+
+int main()
+{
+    std::mt19937_64 rng(22);
+    int start_changes = 0;
+    for (int i = 0; i < 100; ++i) {
+        const FullBoardGame board = random_board(rng, 3, 5, 0.2);
+        const std::string name = "board " + std::to_string(i);
+        FullBoardGame stepped = board;
+        SolverStats stepped_stats;
+        std::optional<Vector2i> start = next_start(board, SolverConfig {}, std::nullopt);
+        while (auto_solve_update(stepped, std::nullopt, SolverConfig {}, stepped_stats)
+               == AutoSolveResult::should_continue) {
+            if (stepped.start_pos() != start) {
+                check(stepped.move_history().empty(), name + " makes no move in the step that changes the start");
+                start_changes++;
+            }
+            else {
+                check(!stepped.move_history().empty(), name + " makes a move in each step on the same start");
+            }
+            start = stepped.start_pos();
+        }
+
+        FullBoardGame solved = board;
+        SolverStats solved_stats;
+        const bool won = auto_solve(solved, SolverConfig {}, solved_stats);
+        check(stepped.won() == won, name + " has the same outcome stepped as solved");
+        check(stepped_stats.nodes == solved_stats.nodes, name + " makes the same moves stepped as solved");
+    }
+    check(start_changes > 0, "some board fails a start while stepping");
+    return test_result();
+}
@@ -0,0 +1,83 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "test_support.hpp"
+
+// flood_fill must reach the same cells as a plain breadth-first search, on the scalar path and, in builds with
+// FBS_ENABLE_AVX2, on the AVX2 one, including lines that end at or just past a word boundary
+
+static std::vector<bool> breadth_first(const std::vector<bool>& open, const int size, const int seed)
+{
+    std::vector<bool> reached(open.size());
+    std::vector<int> queue { seed };
+    reached[seed] = true;
+    for (size_t next = 0; next < queue.size(); ++next) {
+        const int x = queue[next] % size;
+        const int y = queue[next] / size;
+        const int neighbors[4][2] { { x - 1, y }, { x + 1, y }, { x, y - 1 }, { x, y + 1 } };
+        for (const auto [nx, ny] : neighbors) {
+            const int idx = ny * size + nx;
+            if (nx >= 0 && nx < size && ny >= 0 && ny < size && open[idx] && !reached[idx]) {
+                reached[idx] = true;
+                queue.push_back(idx);
+            }
+        }
+    }
+    return reached;
+}
+
+static void check_board(std::mt19937_64& rng, const int size, const double open_chance, const std::string& name)
+{
+    const int words = line_words(size);
+    std::bernoulli_distribution is_open(open_chance);
+    std::vector<bool> open(static_cast<size_t>(size) * size);
+    std::vector<uint64_t> open_lines(static_cast<size_t>(size) * words);
+    std::vector<int> open_cells;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (is_open(rng)) {
+                open[y * size + x] = true;
+                line_set(open_lines.data() + static_cast<size_t>(y) * words, x);
+                open_cells.push_back(y * size + x);
+            }
+        }
+    }
+    if (open_cells.empty()) {
+        return;
+    }
+    const int seed = open_cells[std::uniform_int_distribution<size_t>(0, open_cells.size() - 1)(rng)];
+    std::vector<uint64_t> reached(open_lines.size());
+    line_set(reached.data() + static_cast<size_t>(seed / size) * words, seed % size);
+    const int count = flood_fill(reached.data(), open_lines.data(), size, words);
+
+    const std::vector<bool> expected = breadth_first(open, size, seed);
+    int expected_count = 0;
+    bool same_cells = true;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            expected_count += expected[y * size + x];
+            same_cells = same_cells
+                && line_test(reached.data() + static_cast<size_t>(y) * words, x) == expected[y * size + x];
+        }
+    }
+    check(count == expected_count, name + " counts the reached cells");
+    check(same_cells, name + " reaches the same cells");
+}
+
+int main()
+{
+    std::mt19937_64 rng(20);
+    const double open_chances[] { 0.45, 0.6, 0.8, 0.95 };
+    for (int i = 0; i < 2000; ++i) {
+        const int size = std::uniform_int_distribution(1, 150)(rng);
+        check_board(rng, size, open_chances[i % 4], "board " + std::to_string(i) + " of size " + std::to_string(size));
+    }
+    for (const int size : { 63, 64, 65, 127, 128, 129 }) {
+        for (const double open_chance : open_chances) {
+            check_board(rng, size, open_chance, "edge board of size " + std::to_string(size));
+        }
+    }
+    return test_result();
+}
@@ -0,0 +1,20 @@
+#include <BS_thread_pool.hpp>
+
+#include "parallel_solver.hpp"
+#include "test_support.hpp"
+
+// parallel_solve must reach the same outcome as auto_solve on every board, and leave a playable solution when it wins
+
+int main()
+{
+    BS::thread_pool pool(4);
+    check_matches_auto_solve(7, [&](FullBoardGame& game, const SolverConfig& config, SolverStats& stats) {
+        return parallel_solve(game, pool, config, stats);
+    });
+    check_stop_flag(
+        FullBoardGame(12),
+        [&](FullBoardGame& game, const SolverConfig& config, SolverStats& stats, const SolveLimits& limits) {
+            return parallel_solve(game, pool, config, stats, limits);
+        });
+    return test_result();
+}
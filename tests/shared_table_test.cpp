@@ -0,0 +1,61 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "board_io.hpp"
+#include "full_board_solver.hpp"
+#include "test_support.hpp"
+
+// batch_solver shares one transposition table across every board of a batch, whatever their sizes. A board must reach
+// the same outcome with the shared table as on its own.
+
+static bool solve_alone(const FullBoardGame& board)
+{
+    TranspositionTable table(1 << 16);
+    FullBoardGame game = board;
+    SolverStats stats;
+    return auto_solve(game, make_config(&table), stats);
+}
+
+static void check_batch(const std::vector<FullBoardGame>& boards, const std::string& batch_name)
+{
+    TranspositionTable shared(1 << 16);
+    for (size_t i = 0; i < boards.size(); ++i) {
+        FullBoardGame game = boards[i];
+        SolverStats stats;
+        const bool won = auto_solve(game, make_config(&shared), stats);
+        const std::string name = batch_name + " board " + std::to_string(i) + " ("
+            + format_board(boards[i].size(), boards[i].barrier_positions()) + ")";
+        check(won == solve_alone(boards[i]), name + " has the same outcome as on its own");
+        if (won) {
+            check(replays_to_win(game), name + " has a winning solution");
+        }
+    }
+}
+
+static FullBoardGame parse_board(const std::string_view line)
+{
+    const std::optional<BoardSpec> spec = parse_board_line(line);
+    FullBoardGame game(spec->size);
+    game.set_barriers(spec->barriers);
+    return game;
+}
+
+int main()
+{
+    // Empty boards of every size leave dead positions behind whose filled cells line up with those of smaller boards
+    std::vector<FullBoardGame> descending;
+    for (int size = 8; size >= 1; --size) {
+        descending.emplace_back(size);
+    }
+    descending.push_back(parse_board("3 2 1 0 2"));
+    check_batch(descending, "descending");
+
+    std::mt19937_64 rng(15);
+    std::vector<FullBoardGame> mixed;
+    for (int i = 0; i < 300; ++i) {
+        mixed.push_back(random_board(rng, 1, 8, 0.1));
+    }
+    check_batch(mixed, "mixed");
+    return test_result();
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iterative_solver.hpp"
+#include "small_board_solver.hpp"
+#include "test_support.hpp"
+
+// solve_by_size must make the same moves as IterativeSolver, hash positions as it does so the two can share a table,
+// and stop when its limits say so
+
+static void check_matches_iterative()
+{
+    std::mt19937_64 rng(19);
+    for (int i = 0; i < 300; ++i) {
+        const FullBoardGame board = random_board(rng, 1, 10, 0.12);
+        const std::string name = "board " + std::to_string(i) + " of size " + std::to_string(board.size());
+        TranspositionTable table(1 << 16);
+        FullBoardGame by_size = board;
+        SolverStats by_size_stats;
+        const SolveOutcome outcome = solve_by_size(by_size, make_config(&table), by_size_stats);
+
+        IterativeSolver iterative(board, make_config(nullptr));
+        const bool won = iterative.solve();
+        check(outcome == (won ? SolveOutcome::solved : SolveOutcome::unsolvable), name + " has the same outcome");
+        check(by_size.start_pos() == iterative.start_pos(), name + " starts from the same cell");
+        FullBoardGame replayed = board;
+        iterative.apply_solution(replayed);
+        check(std::ranges::equal(by_size.move_history().packed(), replayed.move_history().packed()),
+              name + " makes the same moves");
+        if (won) {
+            check(replays_to_win(by_size), name + " has a winning solution");
+        }
+        else if (by_size_stats.table_evictions == 0) {
+            // Every start failed, so each was stored dead under the key FullBoardGame gives it
+            for (const Vector2i start : start_candidates(board, make_config(nullptr))) {
+                FullBoardGame started = board;
+                started.track_hash(true);
+                started.set_start(start);
+                check(table.probe(started.hash()), name + " stores its starts under FullBoardGame::hash()");
+            }
+        }
+    }
+}
+
+static void check_limits()
+{
+    FullBoardGame game(8);
+    const std::vector<Vector2i> barriers { { 3, 3 }, { 4, 4 } };
+    game.set_barriers(barriers);
+    check_stop_flag(game, [](FullBoardGame& stopped, const SolverConfig& config, SolverStats& stats,
+                             const SolveLimits& limits) { return solve_by_size(stopped, config, stats, limits); });
+
+    SolveLimits budget;
+    budget.node_budget = 16;
+    SolverStats budget_stats;
+    check(solve_by_size(game, make_config(nullptr), budget_stats, budget) == SolveOutcome::stopped,
+          "a node budget stops the solve");
+    check(budget_stats.nodes <= 16 + 1, "a stopped solve keeps to its node budget");
+}
+
+int main()
+{
+    check_matches_iterative();
+    check_limits();
+    return test_result();
+}
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <random>
+#include <string>
+
+#include "solution_counter.hpp"
+#include "test_support.hpp"
+
+// Counts must match a plain enumeration of every move sequence, whatever the pruning and however small the memo
+
+static uint64_t enumerate(FullBoardGame& game)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!game.move(idx_dir(i)).record.has_value()) {
+            continue;
+        }
+        total += game.won() ? 1 : enumerate(game);
+        game.undo();
+    }
+    return total;
+}
+
+static uint64_t enumerate_all(const FullBoardGame& board)
+{
+    uint64_t total = 0;
+    for (int y = 0; y < board.size(); ++y) {
+        for (int x = 0; x < board.size(); ++x) {
+            FullBoardGame game = board;
+            if (board.barrier_at({ x, y })) {
+                continue;
+            }
+            game.set_start({ x, y });
+            total += enumerate(game);
+        }
+    }
+    return total;
+}
+
+static void check_matches_enumeration()
+{
+    const SolverConfig pruned { .prune_degrees = true,
+                                .prune_connectivity = true,
+                                .reduce_symmetry = true,
+                                .constrain_endpoints = true };
+    std::mt19937_64 rng(12);
+    bool cleared = false;
+    for (int i = 0; i < 60; ++i) {
+        const FullBoardGame board = random_board(rng, 2, 5, 0.15);
+        const std::string name = "board " + std::to_string(i);
+        const uint64_t expected = enumerate_all(board);
+        check(count_solutions(board, SolverConfig {}).total == expected, name + " counts as enumerated");
+        check(count_solutions(board, pruned).total == expected, name + " counts as enumerated with pruning");
+        SolutionCounter small_memo(board, SolverConfig {}, SolveLimits {}, 8);
+        const SolutionCount small = small_memo.count_all();
+        check(small.total == expected, name + " counts as enumerated with a full memo");
+        cleared = cleared || small.memo_clears > 0;
+    }
+    check(cleared, "some count outgrows a memo of 8 positions");
+}
+
+static void check_limits()
+{
+    const FullBoardGame board(6);
+    const SolutionCount whole = count_solutions(board, SolverConfig {});
+    check(whole.complete, "an unlimited count completes");
+
+    SolveLimits budget;
+    budget.node_budget = 1000;
+    const SolutionCount partial = count_solutions(board, SolverConfig {}, budget);
+    check(!partial.complete, "a node budget stops the count");
+    check(partial.total <= whole.total, "a stopped count is a lower bound");
+
+    std::atomic<bool> stop = true;
+    SolveLimits stopped;
+    stopped.stop = &stop;
+    check(count_solutions(board, SolverConfig {}, stopped).total == 0, "a raised stop flag counts nothing");
+}
+
+int main()
+{
+    check_matches_enumeration();
+    check_limits();
+    return test_result();
+}
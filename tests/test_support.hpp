@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "full_board_game.hpp"
+#include "full_board_solver.hpp"
+
+// Each test is its own executable that runs its checks, prints the failed ones and exits with the result for CTest
+
+inline int g_failed_checks = 0;
+
+inline void check(const bool passed, const std::string_view what)
+{
+    if (!passed) {
+        std::cerr << "FAILED: " << what << '\n';
+        g_failed_checks++;
+    }
+}
+
+inline int test_result()
+{
+    return g_failed_checks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// A board of a size between `min_size` and `max_size` with each cell a barrier with probability `barrier_chance`
+inline FullBoardGame random_board(
+    std::mt19937_64& rng, const int min_size, const int max_size, const double barrier_chance)
+{
+    const int size = std::uniform_int_distribution(min_size, max_size)(rng);
+    std::bernoulli_distribution barrier(barrier_chance);
+    std::vector<Vector2i> barriers;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (barrier(rng)) {
+                barriers.push_back({ x, y });
+            }
+        }
+    }
+    FullBoardGame game(size);
+    game.set_barriers(barriers);
+    return game;
+}
+
+// Whether the start and history of `game` win when played again on an empty copy of its layout
+inline bool replays_to_win(const FullBoardGame& game)
+{
+    if (!game.start_pos().has_value()) {
+        return false;
+    }
+    FullBoardGame replay(game.size());
+    replay.set_barriers(game.barrier_positions());
+    replay.set_start(*game.start_pos());
+    for (const FullBoardGame::MoveRecord move : game.move_history()) {
+        if (!replay.move(move.dir).record.has_value()) {
+            return false;
+        }
+    }
+    return replay.won();
+}
+
+// Every pruning on, with `table` for the transposition table when there is one
+inline SolverConfig make_config(TranspositionTable* table)
+{
+    return { .prune_degrees = true,
+             .prune_connectivity = true,
+             .table = table,
+             .reduce_symmetry = true,
+             .constrain_endpoints = true };
+}
+
+// Checks that `solve(game, config, stats)`, a whole-board solver returning SolveOutcome, reaches the outcome auto_solve
+// does on random boards drawn from `seed`, and leaves a winning solution on the game when it wins
+template <typename Solve>
+void check_matches_auto_solve(const uint64_t seed, Solve solve)
+{
+    std::mt19937_64 rng(seed);
+    TranspositionTable sequential_table(1 << 16);
+    TranspositionTable solver_table(1 << 16);
+    for (int i = 0; i < 400; ++i) {
+        const FullBoardGame board = random_board(rng, 1, 7, 0.15);
+        const std::string name = "board " + std::to_string(i) + " of size " + std::to_string(board.size());
+        FullBoardGame sequential = board;
+        SolverStats sequential_stats;
+        const bool won = auto_solve(sequential, make_config(&sequential_table), sequential_stats);
+
+        FullBoardGame game = board;
+        SolverStats stats;
+        const SolveOutcome outcome = solve(game, make_config(&solver_table), stats);
+        check(outcome == (won ? SolveOutcome::solved : SolveOutcome::unsolvable), name + " has the same outcome");
+        if (outcome == SolveOutcome::solved) {
+            check(replays_to_win(game), name + " has a winning solution");
+        }
+    }
+}
+
+// Checks that `solve(game, config, stats, limits)` on `board` stops on a stop flag raised before it begins, and leaves
+// the game with no start
+template <typename Solve>
+void check_stop_flag(const FullBoardGame& board, Solve solve)
+{
+    FullBoardGame game = board;
+    std::atomic<bool> stop = true;
+    SolveLimits limits;
+    limits.stop = &stop;
+    SolverStats stats;
+    check(solve(game, make_config(nullptr), stats, limits) == SolveOutcome::stopped,
+          "a raised stop flag stops the solve");
+    check(!game.start_pos().has_value(), "a stopped solve leaves the game with no start");
+}
@@ -0,0 +1,52 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <BS_thread_pool.hpp>
+
+#include "test_support.hpp"
+#include "work_stealing_solver.hpp"
+
+// work_stealing_solve must reach the same outcome as auto_solve on every board, leave a playable solution when it wins,
+// and finish even when the pool cannot run all of its workers at once
+
+// Called from a task of its own pool, so one worker has to wait for another to finish before it gets a thread
+static void check_busy_pool()
+{
+    BS::thread_pool pool(2);
+    std::mt19937_64 rng(9);
+    for (int i = 0; i < 20; ++i) {
+        const FullBoardGame board = random_board(rng, 4, 6, 0.1);
+        std::vector<WorkerStats> worker_stats;
+        const SolveOutcome outcome = pool.submit_task([&] {
+                                             FullBoardGame game = board;
+                                             SolverStats stats;
+                                             return work_stealing_solve(
+                                                 game, pool, make_config(nullptr), stats, worker_stats);
+                                         })
+                                         .get();
+        FullBoardGame sequential = board;
+        SolverStats sequential_stats;
+        const bool won = auto_solve(sequential, make_config(nullptr), sequential_stats);
+        check(outcome == (won ? SolveOutcome::solved : SolveOutcome::unsolvable),
+              "board " + std::to_string(i) + " on a busy pool has the same outcome");
+    }
+}
+
+int main()
+{
+    BS::thread_pool pool(4);
+    std::vector<WorkerStats> worker_stats;
+    check_matches_auto_solve(8, [&](FullBoardGame& game, const SolverConfig& config, SolverStats& stats) {
+        const SolveOutcome outcome = work_stealing_solve(game, pool, config, stats, worker_stats);
+        check(worker_stats.size() == pool.get_thread_count(), "every worker is reported");
+        return outcome;
+    });
+    check_busy_pool();
+    check_stop_flag(
+        FullBoardGame(12),
+        [&](FullBoardGame& game, const SolverConfig& config, SolverStats& stats, const SolveLimits& limits) {
+            return work_stealing_solve(game, pool, config, stats, worker_stats, limits);
+        });
+    return test_result();
+}